@@ -0,0 +1,232 @@
+/*
+ *  R : A Computer Language for Statistical Data Analysis
+ *  Copyright (C) 1995-1999   Robert Gentleman, Ross Ihaka and the
+ *                            R Development Core Team
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program; if not, a copy is available at
+ *  http://www.r-project.org/Licenses/
+ */
+
+/* C version of the Fortran dqrdc2 routine formerly in dqrdc2.f, which was
+   R's modification of LINPACK's dqrdc, by Ross Ihaka (1995), with bug
+   fixes by BDR (1999).  Its documentation follows:
+
+     dqrdc2 uses householder transformations to compute the qr
+     factorization of an n by p matrix x.  a limited column
+     pivoting strategy based on the 2-norms of the reduced columns
+     moves columns with near-zero norm to the right-hand edge of
+     the x matrix.  this strategy means that sequential one
+     degree-of-freedom effects can be computed in a natural way.
+
+     on entry
+
+        x       double precision(ldx,p), where ldx .ge. n.
+                x contains the matrix whose decomposition is to be
+                computed.
+
+        ldx     integer.
+                ldx is the leading dimension of the array x.
+
+        n       integer.
+                n is the number of rows of the matrix x.
+
+        p       integer.
+                p is the number of columns of the matrix x.
+
+        tol     double precision
+                tol is the nonnegative tolerance used to
+                determine the subset of the columns of x
+                included in the solution.
+
+        jpvt    integer(p).
+                integers which are swapped in the same way as the
+                the columns of x during pivoting.  on entry these
+                should be set equal to the column indices of the
+                columns of the x matrix (typically 1 to p).
+
+        work    double precision(p,2).
+                work is a work array.
+
+     on return
+
+        x       x contains in its upper triangle the upper
+                triangular matrix r of the qr factorization.
+                below its diagonal x contains information from
+                which the orthogonal part of the decomposition
+                can be recovered.  note that if pivoting has
+                been requested, the decomposition is not that
+                of the original matrix x but that of x
+                with its columns permuted as described by jpvt.
+
+        k       integer.
+                k contains the number of columns of x judged
+                to be linearly independent.
+
+        qraux   double precision(p).
+                qraux contains further information required to recover
+                the orthogonal part of the decomposition.
+
+        jpvt    jpvt(k) contains the index of the column of the
+                original matrix that has been interchanged into
+                the k-th column.
+
+   The operations done are the same as in the Fortran version, using the
+   same BLAS routines, so results are identical.  However, the application
+   of each householder transformation to the later columns, which is where
+   almost all the time goes, may be done in parallel using OpenMP, when
+   R_num_math_threads is greater than one.  This doesn't change the results,
+   since the computations for each column are independent. */
+
+#ifdef HAVE_CONFIG_H
+#include <config.h>
+#endif
+
+#include <math.h>
+#include <R_ext/Applic.h>
+#include <R_ext/BLAS.h>
+#ifdef HAVE_OPENMP
+#include <R_ext/MathThreads.h>
+#endif
+
+/* Minimum number of elements in the columns updated with a householder
+   transformation for this to be done in parallel. */
+
+#define DQRDC2_PAR_THRESHOLD 100000
+
+/* Apply the householder transformation in column l (from 1) to column j,
+   and update its norm (in qraux) and, if it's recomputed, work(j,1). */
+
+static void dqrdc2_update (double *x, int ldx, int n, int l, int j,
+                           double *qraux, double *work)
+{
+    int one = 1, nl = n-l+1, nl1 = n-l;
+    double *xl = x + (size_t) (l-1)*ldx + (l-1);
+    double *xj = x + (size_t) (j-1)*ldx + (l-1);
+    double t, tt;
+
+    t = -F77_CALL(ddot)(&nl, xl, &one, xj, &one) / *xl;
+    F77_CALL(daxpy)(&nl, &t, xl, &one, xj, &one);
+
+    if (qraux[j-1] != 0.0) {
+        tt = fabs(*xj) / qraux[j-1];
+        tt = 1.0 - tt*tt;
+        if (tt < 0.0) tt = 0.0;
+        t = tt;
+        if (fabs(t) < 1e-6) {
+            qraux[j-1] = F77_CALL(dnrm2)(&nl1, xj+1, &one);
+            work[j-1] = qraux[j-1];
+        }
+        else
+            qraux[j-1] = qraux[j-1] * sqrt(t);
+    }
+}
+
+void F77_SUB(dqrdc2)(double *x, int *pldx, int *pn, int *pp, double *ptol,
+                     int *k, double *qraux, int *jpvt, double *work)
+{
+    int ldx = *pldx, n = *pn, p = *pp;
+    double tol = *ptol;
+    double *work2 = work + p;  /* work(.,2) */
+    int one = 1;
+    int i, j, l, lup;
+    double t, tt, ttt, nrmxl;
+
+    /* Compute the norms of the columns of x. */
+
+    for (j = 1; j <= p; j++) {
+        qraux[j-1] = F77_CALL(dnrm2)(&n, x + (size_t)(j-1)*ldx, &one);
+        work[j-1] = qraux[j-1];
+        work2[j-1] = qraux[j-1];
+        if (work2[j-1] == 0.0) work2[j-1] = 1.0;
+    }
+
+    /* Perform the householder reduction of x. */
+
+    lup = n < p ? n : p;
+    *k = p + 1;
+
+    for (l = 1; l <= lup; l++) {
+
+        /* Cycle the columns from l to p left-to-right until one with
+           non-negligible norm is located.  A column is considered to
+           have become negligible if its norm has fallen below tol times
+           its original norm.  The check for l <= k avoids infinite
+           cycling. */
+
+        while (l < *k && qraux[l-1] < work2[l-1]*tol) {
+            for (i = 1; i <= n; i++) {
+                double *xi = x + (i-1);
+                t = xi[(size_t)(l-1)*ldx];
+                for (j = l+1; j <= p; j++)
+                    xi[(size_t)(j-2)*ldx] = xi[(size_t)(j-1)*ldx];
+                xi[(size_t)(p-1)*ldx] = t;
+            }
+            i = jpvt[l-1];
+            t = qraux[l-1];
+            tt = work[l-1];
+            ttt = work2[l-1];
+            for (j = l+1; j <= p; j++) {
+                jpvt[j-2] = jpvt[j-1];
+                qraux[j-2] = qraux[j-1];
+                work[j-2] = work[j-1];
+                work2[j-2] = work2[j-1];
+            }
+            jpvt[p-1] = i;
+            qraux[p-1] = t;
+            work[p-1] = tt;
+            work2[p-1] = ttt;
+            *k = *k - 1;
+        }
+
+        if (l == n)
+            break;
+
+        /* Compute the householder transformation for column l. */
+
+        double *xl = x + (size_t)(l-1)*ldx + (l-1);
+        int nl = n-l+1;
+
+        nrmxl = F77_CALL(dnrm2)(&nl, xl, &one);
+        if (nrmxl == 0.0)
+            continue;
+
+        if (*xl != 0.0) nrmxl = *xl < 0 ? -fabs(nrmxl) : fabs(nrmxl);
+        t = 1.0/nrmxl;
+        F77_CALL(dscal)(&nl, &t, xl, &one);
+        *xl = 1.0 + *xl;
+
+        /* Apply the transformation to the remaining columns, updating
+           the norms. */
+
+#ifdef HAVE_OPENMP
+        if (R_num_math_threads > 1
+              && (double) nl * (p-l) >= DQRDC2_PAR_THRESHOLD) {
+#           pragma omp parallel for num_threads(R_num_math_threads) \
+                                    schedule(static)
+            for (j = l+1; j <= p; j++)
+                dqrdc2_update (x, ldx, n, l, j, qraux, work);
+        }
+        else
+#endif
+        for (j = l+1; j <= p; j++)
+            dqrdc2_update (x, ldx, n, l, j, qraux, work);
+
+        /* Save the transformation. */
+
+        qraux[l-1] = *xl;
+        *xl = -nrmxl;
+    }
+
+    *k = *k - 1 < n ? *k - 1 : n;
+}
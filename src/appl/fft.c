@@ -23,6 +23,7 @@
 #endif
 
 #include <stdlib.h> /* for abs */
+#include <string.h> /* for memcpy */
 #include <math.h>
 #include <Rmath.h> /* for imax2(.),..*/
 #include <R_ext/Applic.h>
@@ -48,9 +49,14 @@
  *	if maxp is one,	 the internal nfac array was too small.	 This can only
  *	happen for series lengths which exceed 12,754,584.
  *
- * PROBLEM (see fftmx  below):	nfac[] is overwritten by fftmx() in fft_work()
- * -------  Consequence:  fft_factor() must be called way too often,
- * at least from  do_mvfft() [ ../main/fourier.c ]
+ * fftmx() below overwrites the nfac[] array it is passed, so fft_work()
+ * would need fft_factor() to be called again before every transform.
+ * fft_plan_factor() and fft_plan_work() avoid this, and the use of global
+ * variables, by keeping the factorization in an fft_plan structure that
+ * fft_plan_work() does not change (it works on a copy of nfac[]).  A plan
+ * can therefore be reused for any number of transforms of the same
+ * length, including ones done concurrently in several threads.  The old
+ * fft_factor() and fft_work() interface is kept, using a global plan.
  *
  *	The following arrays need to be allocated following the call to
  *	fft_factor and preceding the call to fft_work.
@@ -721,49 +727,43 @@ L570:
     if( nt >= 0) goto L_ord;
 } /* fftmx */
 
-static int old_n = 0;
-
-static int nfac[15];
-static int m_fac;
-static int kt;
-static int maxf;
-static int maxp;
-
-/* At the end of factorization,	 
- *	nfac[]	contains the factors,
- *	m_fac	contains the number of factors and 
- *	kt	contains the number of square factors  */
-
-/* non-API, but used by package RandomFields */
-void fft_factor(int n, int *pmaxf, int *pmaxp)
-{
-/* fft_factor - factorization check and determination of memory
- *		requirements for the fft.
+/* Factor n, storing the factorization in *plan, which afterwards
+ * contains in nfac[] the factors, in m_fac the number of factors, and in
+ * kt the number of square factors.
  *
- * On return,	*pmaxf will give the maximum factor size
- * and		*pmaxp will give the amount of integer scratch storage required.
+ * On return,	plan->maxf will give the maximum factor size
+ * and		plan->maxp will give the amount of integer scratch storage
+ *		required.
  *
- * If *pmaxf == 0, there was an error, the error type is indicated by *pmaxp:
+ * If plan->maxf == 0, there was an error, the error type is indicated by
+ * plan->maxp:
  *
- *  If *pmaxp == 0  There was an illegal zero parameter among nseg, n, and nspn.
- *  If *pmaxp == 1  There we more than 15 factors to ntot.  */
+ *  If maxp == 0  There was an illegal zero parameter among nseg, n, and nspn.
+ *  If maxp == 1  There we more than 15 factors to ntot.  */
 
-    int j, jj, k;
+void fft_plan_factor(fft_plan *plan, int n)
+{
+    int *nfac = plan->nfac;
+    int j, jj, k, m_fac, kt, maxf, maxp;
 
 	/* check series length */
 
     if (n <= 0) {
-	old_n = 0; *pmaxf = 0; *pmaxp = 0;
+	plan->n = 0; plan->maxf = 0; plan->maxp = 0;
 	return;
     }
-    else old_n = n;
 
 	/* determine the factors of n */
 
     m_fac = 0;
+    kt = 0;
+    maxp = 1;
     k = n;/* k := remaining unfactored factor of n */
-    if (k == 1)
+    if (k == 1) {
+	plan->n = 1; plan->m_fac = 0; plan->kt = 0;
+	plan->maxf = 1; plan->maxp = 1;
 	return;
+    }
 
 	/* extract square factors first ------------------ */
 
@@ -811,7 +811,7 @@ void fft_factor(int n, int *pmaxf, int *pmaxp)
     if (m_fac <= kt+1)
 	maxp = m_fac+kt+1;
     if (m_fac+kt > 15) {		/* error - too many factors */
-	old_n = 0; *pmaxf = 0; *pmaxp = 0;
+	plan->n = 0; plan->maxf = 0; plan->maxp = 0;
 	return;
     }
     else {
@@ -826,34 +826,74 @@ void fft_factor(int n, int *pmaxf, int *pmaxp)
 	if (kt > 1) maxf = imax2(nfac[kt-2], maxf);
 	if (kt > 2) maxf = imax2(nfac[kt-3], maxf);
     }
-    *pmaxf = maxf;
-    *pmaxp = maxp;
+
+    plan->n = n;
+    plan->m_fac = m_fac;
+    plan->kt = kt;
+    plan->maxf = maxf;
+    plan->maxp = maxp;
 }
-
 
-Rboolean fft_work(double *a, double *b, int nseg, int n, int nspn, int isn,
-		  double *work, int *iwork)
-{
-    int nf, nspan, ntot;
 
-	/* check that factorization was successful */
+/* Do the transform of length plan->n for which *plan was set up by
+ * fft_plan_factor().  The plan is not modified, so it may be used again,
+ * or simultaneously in another thread (with different work and iwork). */
 
-    if(old_n == 0) return FALSE;
+Rboolean fft_plan_work(const fft_plan *plan, double *a, double *b,
+		       int nseg, int nspn, int isn, double *work, int *iwork)
+{
+    int nfac[15];
+    int nf, nspan, ntot, maxf;
 
-	/* check that the parameters match those of the factorization call */
+	/* check that factorization was successful, and other parameters */
 
-    if(n != old_n || nseg <= 0 || nspn <= 0 || isn == 0)
+    if (plan->n == 0 || nseg <= 0 || nspn <= 0 || isn == 0)
 	return FALSE;
 
-	/* perform the transform */
+    if (plan->n == 1)
+	return TRUE;
 
-    nf = n;
+	/* perform the transform, on a copy of the factors */
+
+    memcpy (nfac, plan->nfac, sizeof nfac);
+
+    nf = plan->n;
     nspan = nf * nspn;
     ntot = nspan * nseg;
+    maxf = plan->maxf;
 
-    fftmx(a, b, ntot, nf, nspan, isn, m_fac, kt,
+    fftmx(a, b, ntot, nf, nspan, isn, plan->m_fac, plan->kt,
 	  &work[0], &work[maxf], &work[2*maxf], &work[3*maxf],
 	  iwork, nfac);
 
     return TRUE;
 }
+
+
+/* The old interface, using a global plan.  Non-API, but used by package
+ * RandomFields. */
+
+static fft_plan global_plan;
+
+void fft_factor(int n, int *pmaxf, int *pmaxp)
+{
+    fft_plan_factor(&global_plan, n);
+
+    if (n != 1) {
+	*pmaxf = global_plan.maxf;
+	*pmaxp = global_plan.maxp;
+    }
+}
+
+Rboolean fft_work(double *a, double *b, int nseg, int n, int nspn, int isn,
+		  double *work, int *iwork)
+{
+	/* check that the parameters match those of the factorization call */
+
+    if (n != global_plan.n)
+	return FALSE;
+
+	/* perform the transform */
+
+    return fft_plan_work(&global_plan, a, b, nseg, nspn, isn, work, iwork);
+}
@@ -41,6 +41,7 @@ char *Rf_task_name (helpers_task_proc *task)
     /* a */
     TASK_NAME(rowSums_or_rowMeans);
     TASK_NAME(colSums_or_colMeans);
+    TASK_NAME(matrix_stat);
     /* b */
     TASK_NAME(transpose);
     /* c */
@@ -89,6 +90,12 @@ char *Rf_task_name (helpers_task_proc *task)
     TASK_NAME(par_matprod_trans2);
     /* t */
     TASK_NAME(copy_coerced);
+    TASK_NAME(mvfft);
+    TASK_NAME(rng_streams);
+    TASK_NAME(cov);
+    TASK_NAME(group_stat);
+    TASK_NAME(cum_summary);
+    TASK_NAME(cum);
     /* v */
     /* w */
     /* x */
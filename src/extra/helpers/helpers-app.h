@@ -78,13 +78,15 @@ typedef SEXP helpers_var_ptr;
 #ifndef HELPERS_DISABLED
 #ifdef R_TASK_MERGING
 
-#define MAX_OPS_MERGED 3      /* Must be 3 for the current implementation */
+#define MAX_OPS_MERGED 6      /* Up to 3 done with specialized code; must
+                                 be no more than 7 to fit in helpers_op_t */
 
 #define HELPERS_TASK_DATA_AMT MAX_OPS_MERGED
 
 #define helpers_can_merge(out,proc_a,op_a,in1_a,in2_a,proc_b,op_b,in1_b,in2_b) \
    ((proc_b) != task_merged_arith_abs \
-     || ((op_b) & (0x7f<<(8*MAX_OPS_MERGED))) == 0 /* not already at maximum */)
+     || ((op_b) & ((helpers_op_t)0x7f<<(8*MAX_OPS_MERGED))) == 0 \
+                                           /* not already at maximum */)
 
 #define helpers_merge(out,proc_a,op_a,in1_a,in2_a, \
                           proc_b_ptr,op_b_ptr,in1_b_ptr,in2_b_ptr, \
@@ -107,7 +109,7 @@ typedef SEXP helpers_var_ptr;
 #ifndef HELPERS_DISABLED
 #ifdef R_TASK_MERGING
 
-extern helpers_task_proc task_merged_arith_abs, task_abs;
+extern helpers_task_proc task_merged_arith_abs, task_abs, task_math1;
 
 extern int helpers_merge_proc ( /* helpers_var_ptr out, */
   helpers_task_proc *proc_A, helpers_op_t op_A, 
@@ -138,6 +140,11 @@ extern char *Rf_var_name (helpers_var_ptr);
 #define helpers_var_name(v) Rf_var_name(v)
 
 
+/* LENGTH OF A VARIABLE, FOR COUNTS OF ELEMENTS PROCESSED BY TASKS. */
+
+#define helpers_var_length(v) ((double) XLENGTH(v))
+
+
 /* MACROS TO COMBINE TWO LENGTHS INTO AN OPERAND, AND TO EXTRACT THEM. */
 
 #define COMBINE_LENGTHS(_a_,_b_) (((helpers_op_t)(_a_)<<32) | (_b_))
@@ -125,6 +125,10 @@ typedef union { omp_lock_t lock; double pad[8]; } my_lock_t;
 #define HELPERS_TASK_DATA_AMT 1
 #endif
 
+#ifndef helpers_var_length
+#define helpers_var_length(v) 0
+#endif
+
 
 /* NULL VARIABLE POINTER, AND VARIABLE NAME MACRO HANDLING NULL. */
 
@@ -285,6 +289,7 @@ static union task_entry
     signed char needed;            /* Needed by master? (+1 finish, -1 start) */
     tix pipe[3];                   /* Tasks producing inputs, 0 when done */
     short flags;                   /* Flags task was scheduled with */
+    char timed;                    /* Record start and done times? */
     helpers_task_proc *task_to_do; /* Task procedure to execute */
     helpers_op_t op;               /* The unsigned integer operand */
     helpers_var_ptr var[3];        /* The output variable, [0], and the input 
@@ -311,7 +316,8 @@ static union task_entry
     helpers_size_t first_amt[3];   /* First non-zero value from helpers_availN*/
     helpers_size_t last_amt[3];    /* Last value from helpers_availN */
 
-    /* The fields below are used only when ENABLE_TRACE is 3 or more. */
+    /* The fields below are used only when ENABLE_TRACE is 3 or more, or
+       when the "timed" field is 1. */
 
     double start_wtime;            /* Wall clock time when started */
     double done_wtime;             /* Wall clock time when done */
@@ -428,6 +434,8 @@ static struct task_info *this_task_info     /* Pointer to info for this_task, */
 
 int helpers_are_disabled = 0;    /* 1 if helpers currently disabled */
 
+volatile int helpers_master_waiting = 0; /* 1 while master waits for tasks */
+
 #ifdef helpers_can_merge
 int helpers_not_merging = 0;     /* 1 if task merging is not enabled */
 int helpers_not_merging_now = 0; /* 1 if task merging not done at the moment */
@@ -485,6 +493,19 @@ static struct stats
 } stats[HELPERS_MAX+1];
 
 
+/* COUNTS AND TIMES FOR TASK PROCEDURES.  Kept only when enabled by
+   helpers_timing, in a table with an entry for each task procedure seen, 
+   up to MAX_TIMING_PROCS (after which further procedures are ignored).
+   The table is updated and read only in the master thread. */
+
+#define MAX_TIMING_PROCS 128
+
+static char timing = 0;   /* Are we recording counts and times now? */
+
+static struct helpers_timing_entry timing_table[MAX_TIMING_PROCS];
+static int timing_procs = 0;  /* Number of entries in timing_table in use */
+
+
 /* FORWARD DECLARATIONS OF STATIC PROCEDURES. */
 
 static void do_task_in_master (int);
@@ -1105,6 +1126,73 @@ static void trace_done_waiting (void)
 
 /* --------------------------  UTILITY PROCEDURES  -------------------------- */
 
+/* FIND THE TIMING TABLE ENTRY FOR A TASK PROCEDURE.  Creates a new entry 
+   if there isn't one already, returning a null pointer if the table is full.
+   The entry found last time is checked first, since it's often the same. */
+
+static struct helpers_timing_entry *timing_entry (helpers_task_proc *proc)
+{
+  static int last = 0;
+  struct helpers_timing_entry *e;
+  int i;
+
+  if (last<timing_procs && timing_table[last].proc==proc)
+  { return &timing_table[last];
+  }
+
+  for (i = 0; i<timing_procs; i++)
+  { if (timing_table[i].proc==proc)
+    { last = i;
+      return &timing_table[i];
+    }
+  }
+
+  if (timing_procs==MAX_TIMING_PROCS)
+  { return 0;
+  }
+
+  last = timing_procs;
+  timing_procs += 1;
+
+  e = &timing_table[last];
+  e->proc = proc;
+  e->master_now = e->master = e->helper = e->merged = 0;
+  e->elements = e->time = 0;
+
+  return e;
+}
+
+
+/* RECORD COMPLETION OF A TASK IN THE TIMING TABLE.  The "where" argument is
+   0 for a task done directly in the master, 1 for a scheduled task done in 
+   the master, and 2 for a task done in a helper.  The number of elements is 
+   taken to be the largest length of the output and input variables. */
+
+static void timing_done (helpers_task_proc *proc, int where, 
+                         helpers_var_ptr out, helpers_var_ptr in1, 
+                         helpers_var_ptr in2, double time)
+{
+  struct helpers_timing_entry *e = timing_entry(proc);
+  double n, l;
+
+  if (e==0)
+  { return;
+  }
+
+  if (where==0)      e->master_now += 1;
+  else if (where==1) e->master += 1;
+  else               e->helper += 1;
+
+  n = 0;
+  if (out!=null && (l = helpers_var_length(out)) > n) n = l;
+  if (in1!=null && (l = helpers_var_length(in1)) > n) n = l;
+  if (in2!=null && (l = helpers_var_length(in2)) > n) n = l;
+
+  e->elements += n;
+  e->time += time;
+}
+
+
 /* RUN THE TASK JUST TAKEN.  When called, the new task should be in this_task,
    with its info in this_task_info.  A flush operation (explicit or implicit)
    should be done before calling this procedure. */
@@ -1121,15 +1209,16 @@ static void run_this_task (void)
     this_task_info->last_amt[0] = 0;
     this_task_info->last_amt[1] = 0;
     this_task_info->last_amt[2] = 0;
-    if (ENABLE_TRACE>2)
-    { this_task_info->start_wtime = WTIME();
-    }
+  }
+
+  if (ENABLE_TRACE>2 || this_task_info->timed)
+  { this_task_info->start_wtime = WTIME();
   }
 
   this_task_info->task_to_do (this_task_info->op, this_task_info->var[0], 
                               this_task_info->var[1], this_task_info->var[2]);
 
-  if (ENABLE_TRACE>2) 
+  if (ENABLE_TRACE>2 || this_task_info->timed) 
   { this_task_info->done_wtime = WTIME();
   }
 
@@ -1517,6 +1606,14 @@ static void notice_completed_proc (void)
       /* Increment count of tasks done by helper/master that did this task. */
   
       if (ENABLE_STATS) stats[info->helper].tasks_done += 1;
+
+      /* Record count and time for this task, if timing enabled. */
+
+      if (timing && info->timed)
+      { timing_done (info->task_to_do, info->helper>0 ? 2 : 1, info->var[0],
+                     info->var[1], info->var[2], 
+                     info->done_wtime - info->start_wtime);
+      }
   
       /* Write trace output showing task completion, if trace enabled. 
          Also write debug output, if any was produced. */
@@ -1636,6 +1733,8 @@ static void mark_as_needed (struct task_info *info, int needed)
 
 static void wait_while_any_needed (void)
 {
+  helpers_master_waiting = 1;
+
   loop:
   { int i; hix h;
 
@@ -1651,6 +1750,8 @@ static void wait_while_any_needed (void)
       }
     }
   }
+
+  helpers_master_waiting = 0;
 }
 
 
@@ -2080,10 +2181,25 @@ void helpers_do_task
          merged task.  Removes the old task from the on_hold queue
          if it was there but the merged task will not be. */
 
+      helpers_task_proc *old_proc = m->task_to_do;
+
       int flags_to_clear = helpers_merge (out, task_to_do, op, in1, in2, 
                              &m->task_to_do, &m->op, &m->var[1], &m->var[2],
                              task_data_loc);
 
+      /* Count the tasks merged, if timing enabled.  The task merged into
+         is counted only the first time it is merged. */
+
+      if (timing)
+      { struct helpers_timing_entry *e;
+        if ((e = timing_entry(task_to_do)) != 0)
+        { e->merged += 1;
+        }
+        if (m->task_to_do != old_proc && (e = timing_entry(old_proc)) != 0)
+        { e->merged += 1;
+        }
+      }
+
       m->flags &= ~ (HELPERS_MERGE_IN_OUT | HELPERS_PIPE_OUT);
       m->flags |= flags & (HELPERS_MERGE_OUT | HELPERS_PIPE_OUT);
       m->flags &= ~ (flags_to_clear & (HELPERS_MERGE_OUT | HELPERS_HOLD 
@@ -2433,6 +2549,7 @@ void helpers_do_task
 
     info->helper = -1;
     info->needed = 0;
+    info->timed = timing;
 
     /* Clear 'done' and 'amt_out' in the task info for the new task.  Not
        necessary in a task done directly in the master (since never seen). */
@@ -2664,17 +2781,23 @@ direct:
     this_task_info->last_amt[0] = 0;
     this_task_info->last_amt[1] = 0;
     this_task_info->last_amt[2] = 0;
-    if (ENABLE_TRACE>2)
-    { this_task_info->start_wtime = WTIME();
-    }
+  }
+
+  if (ENABLE_TRACE>2 || timing)
+  { this_task_info->start_wtime = WTIME();
   }
 
   task_to_do (op, out, in1, in2);
 
-  if (ENABLE_TRACE>2)
+  if (ENABLE_TRACE>2 || timing)
   { this_task_info->done_wtime = WTIME();
   }
 
+  if (timing)
+  { timing_done (task_to_do, 0, out, in1, in2,
+                 this_task_info->done_wtime - this_task_info->start_wtime);
+  }
+
   if (trace) trace_completed (0);
 
 # if ENABLE_DEBUG
@@ -3327,6 +3450,66 @@ helpers_var_ptr *helpers_var_list (int out_only)
 }
 
 
+/* FIND THE TASK PROCEDURES BEING RUN.  Stores in procs[0] the procedure for
+   the task being done by the master (null if none), and in procs[h] the
+   procedure for the task being done by helper h, for h from 1 to 
+   helpers_num, returning helpers_num+1, the number of entries stored.  
+   Doesn't lock or flush, so the results may be slightly out of date, but 
+   may be called from a signal handler in the master thread (as is done for 
+   profiling), since it only reads the task information. */
+
+int helpers_running (helpers_task_proc **procs)
+{
+  int i, n;
+
+  for (i = 0; i<=helpers_num; i++)
+  { procs[i] = 0;
+  }
+
+  n = helpers_tasks;
+
+  for (i = 0; i<n; i++)
+  { struct task_info *info = &task[used[i]].info;
+    hix h; char d;
+    ATOMIC_READ_CHAR (h = info->helper);
+    ATOMIC_READ_CHAR (d = info->done);
+    if (h>=0 && h<=helpers_num && !d)
+    { procs[h] = info->task_to_do;
+    }
+  }
+
+  return helpers_num+1;
+}
+
+
+/* ENABLE OR DISABLE KEEPING COUNTS AND TIMES FOR TASK PROCEDURES.  Tasks
+   scheduled while timing is disabled are not counted even if it is enabled
+   before they finish. */
+
+void helpers_timing (int a)
+{
+  timing = a!=0;
+}
+
+
+/* RESET COUNTS AND TIMES FOR TASK PROCEDURES TO ZERO. */
+
+void helpers_timing_reset (void)
+{
+  timing_procs = 0;
+}
+
+
+/* GET THE TABLE OF COUNTS AND TIMES FOR TASK PROCEDURES.  Stores a pointer
+   to the table in *e, and returns the number of entries. */
+
+int helpers_timing_table (struct helpers_timing_entry **e)
+{
+  *e = timing_table;
+  return timing_procs;
+}
+
+
 /* SET FLAG MASK AND "NOW" VARIABLES ACCORDING TO CURRENT OPTIONS. */
 
 static void set_flag_mask_now (void)
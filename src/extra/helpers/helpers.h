@@ -30,6 +30,20 @@ typedef void helpers_task_proc \
   (helpers_op_t, helpers_var_ptr, helpers_var_ptr, helpers_var_ptr);
 
 
+/* ENTRY IN TABLE OF COUNTS AND TIMES FOR TASK PROCEDURES.  Returned by
+   helpers_timing_table, when timing has been enabled with helpers_timing. */
+
+struct helpers_timing_entry
+{ helpers_task_proc *proc;   /* Task procedure these counts pertain to */
+  double master_now;         /* Number of times done directly in the master */
+  double master;             /* Number of times scheduled, done in master */
+  double helper;             /* Number of times done in a helper thread */
+  double merged;             /* Number of times merged into another task */
+  double elements;           /* Total elements processed (if app tells) */
+  double time;               /* Total elapsed time in seconds when doing it */
+};
+
+
 /* MAXIMUM NUMBER OF HELPER THREADS.  Must be no more than 127 (to fit in
    a signed char). */
 
@@ -238,6 +252,12 @@ void helpers_no_pipelining (int);    /* Disable/re-enable pipelining */
 static helpers_var_ptr helpers_var_list_null[1] = { (helpers_var_ptr) 0 };
 
 #define helpers_var_list(a)          helpers_var_list_null
+#define helpers_running(p)           0
+#define helpers_master_waiting       0
+
+#define helpers_timing(a)            0
+#define helpers_timing_reset()       0
+#define helpers_timing_table(e)      0
 
 #define helpers_trace(f)             0
 #define helpers_stats()              0
@@ -299,6 +319,13 @@ double *helpers_task_data (void);     /* Get pointer to data for merged task */
 
 helpers_var_ptr *helpers_var_list(int);  /* Return list of variables in use */
 
+int helpers_running (helpers_task_proc **); /* Find task procs being run */
+extern volatile int helpers_master_waiting; /* 1 while master waits for tasks */
+
+void helpers_timing (int);           /* Set whether task counts/times kept */
+void helpers_timing_reset (void);    /* Reset task counts/times to zero */
+int helpers_timing_table (struct helpers_timing_entry **); /* Get table */
+
 void helpers_trace (int);            /* Set whether trace info is written */
 void helpers_stats (void);           /* Print statistics */
 void helpers_disable (int);          /* Disable/re-enable helpers */
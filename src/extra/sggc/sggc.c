@@ -921,6 +921,13 @@ static sggc_cptr_t sggc_alloc_kind_type_length (sggc_kind_t kind,
     }
   }
 
+  /* Count a new segment, or a big segment taken from 'unused', as being
+     in use for this kind. */
+
+  if (u == SGGC_NO_OBJECT || big)
+  { sggc_kind_segments[kind] += 1;
+  }
+
   /* Add the object to 'uncollected[kind]' or 'free_or_new[kind]', now
      that we know there won't be a failure. */
 
@@ -1916,6 +1923,7 @@ void sggc_collect_remove_free_big (void)
         }
         sbset_add(&unused,v); /* allowed since v was removed with sbset_first */
                               /*   and it was the only value in its segment   */
+        sggc_kind_segments[k] -= 1;
       }
     }
   }
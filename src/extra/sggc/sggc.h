@@ -242,6 +242,12 @@ SGGC_EXTERN struct sggc_info
 
 } sggc_info;
 
+/* NUMBERS OF SEGMENTS IN USE FOR EACH KIND.  Big segments that are not
+   currently in use (but kept for re-use) are not counted, nor are segments 
+   for constants. */
+
+SGGC_EXTERN unsigned sggc_kind_segments[SGGC_N_KINDS];
+
 
 /* TRACED COMPRESSED POINTER AND ASSOCIATED INFORMATION. */
 
@@ -1011,6 +1011,11 @@ LibExtern int R_interrupts_pending INI_as(0);
 
 extern0 int R_parse_dotdot INI_as(1); /* 1 = parsing .. enabled, 0 = not */
 
+/* Are large vectors of random values generated in blocks from separate
+   streams (see random.c)?  Linked to option "rng_streams". */
+
+extern0 int R_rng_streams INI_as(0);
+
 /* R Home Directory */
 LibExtern char *R_Home;		    /* Root of the R tree */
 
@@ -1057,6 +1062,17 @@ extern uintptr_t R_CStackLimit  INI_as((uintptr_t)-1);/* C stack limit */
 
 #define R_Profiling R_high_frequency_globals.Profiling
 
+/* Counts and times for calls of primitives, enabled by Rprofcounts.  See 
+   eval.c.  The begin procedure is called only if R_PrimCounting is 
+   non-zero, and the end procedure only if begin was called, with a local 
+   R_prim_timing structure holding their state. */
+
+#define R_PrimCounting R_high_frequency_globals.PrimCounting
+
+typedef struct { uint64_t start, child; } R_prim_timing;
+void R_prim_count_begin (R_prim_timing *);
+void R_prim_count_end (R_prim_timing *, SEXP);
+
 /* What to do for R_CStackDir if not a defined constant from compiler option. */
 
 #ifndef R_CStackDir
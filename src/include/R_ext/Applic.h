@@ -136,15 +136,28 @@ int F77_NAME(rs)(int *nm, int *n, double *a, double *w,
 		 int *matz, double *z, double *fv1, double *fv2, int *ierr);
 
 /* appl/fft.c */
-/* NOTE:  The following functions use GLOBAL (static) variables !!
- * ----   some of R-core think that this should be changed,
- *        which will INEVITABLY extend the argument lists ...!
+/* NOTE:  fft_factor and fft_work use GLOBAL (static) variables.
+ * ----   fft_plan_factor and fft_plan_work keep the factorization in
+ *        an fft_plan instead, which can be reused, and shared by threads.
  */
 /* non-API, but used by package RandomFields */
 void fft_factor(int n, int *pmaxf, int *pmaxp);
 Rboolean fft_work(double *a, double *b, int nseg, int n, int nspn,
 /* TRUE: success */ int isn, double *work, int *iwork);
 
+typedef struct {
+    int n;         /* length factored, 0 if factorization failed */
+    int m_fac;     /* number of factors */
+    int kt;        /* number of square factors */
+    int maxf;      /* maximum factor; work needs 4*maxf doubles, 0 if error */
+    int maxp;      /* size of iwork needed; error type if maxf is 0 */
+    int nfac[15];  /* the factors */
+} fft_plan;
+
+void fft_plan_factor(fft_plan *plan, int n);
+Rboolean fft_plan_work(const fft_plan *plan, double *a, double *b, int nseg,
+/* TRUE: success */ int nspn, int isn, double *work, int *iwork);
+
 /* appl/fmin.c : non-API, but used in package ape */
 double Brent_fmin(double ax, double bx, double (*f)(double, void *),
 		  void *info, double tol);
@@ -67,7 +67,8 @@ struct Rconn {
     /* Buffers used both for performance and for conversion.  It's assumed
        that no MBCS char will ever not fit. */
     char iconvbuff[25], oconvbuff[50], *next, init_out[25];
-    short navail, inavail;
+    int navail;
+    short inavail;
     Rboolean EOF_signalled;
 
     Rboolean UTF8out;
@@ -77,6 +78,11 @@ struct Rconn {
 
     char saved_iconvbuff[25];  /* saved for help in finding position for seek */
     int n_saved;
+
+    void *prefetch;  /* state for reading ahead in another thread, or NULL */
+
+    char *rbuff;  /* larger buffer used instead of iconvbuff when input is
+                     not converted, or NULL */
 };
 
 
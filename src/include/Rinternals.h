@@ -1991,6 +1991,7 @@ LibExtern struct {
     SEXP Srcref;                  /* Current srcref, for debuggers */
     SEXP BraceSymbol;             /* Symbol { */
     short Profiling;              /* Whether performance profiling enabled */
+    short PrimCounting;           /* Whether primitive counts/times recorded */
 } R_high_frequency_globals;
 
 #define InitHighFrequencyGlobals() \
@@ -2003,6 +2004,7 @@ do \
     R_high_frequency_globals.scalar_stack = R_scalar_stack_start; \
     R_high_frequency_globals.PPStackSize  = R_PPSSIZE; \
     R_high_frequency_globals.Profiling    = 0; \
+    R_high_frequency_globals.PrimCounting = 0; \
     R_high_frequency_globals.local_protect_start = NULL; \
 } while (0)
 
@@ -3,7 +3,7 @@
  *  (C) Copyright 2008-11 Simon Urbanek
  *      Copyright 2011 R Core Development Team.
  *
- *  Modifications for pqR Copyright (c) 2014, 2015 Radford M. Neal.
+ *  Modifications for pqR Copyright (c) 2014, 2015, 2026 Radford M. Neal.
  *
  *  This program is free software; you can redistribute it and/or modify
  *  it under the terms of the GNU General Public License as published by
@@ -35,6 +35,11 @@
 #include <sys/wait.h>
 #include <signal.h>
 #include <errno.h>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <limits.h>
+#include <string.h>
+#include <stdint.h>
 
 #include <R.h>
 #include <Rinternals.h>
@@ -243,6 +248,188 @@ SEXP mc_send_master(SEXP what)
     return ScalarLogical(1);
 }
 
+/* Values sent from a child to the master with mc_send_master_value are
+   serialized directly, without first creating a raw vector.  If the
+   serialized form is no bigger than MC_SHARED_MIN bytes, it is sent
+   through the pipe, exactly as for mc_send_master.  Otherwise, it is put
+   in a file (in the session's temporary directory, which children share
+   with the master) that is mapped into memory, and only the size and
+   name of the file are sent through the pipe, preceded by a length of
+   MC_SHARED_LEN.  The master unserializes directly from a mapping of
+   this file, then deletes it.  This avoids copying large results through
+   the pipe, and into and out of raw vectors. */
+
+#define MC_SHARED_MIN 65536
+#define MC_SHARED_LEN 0xffffffffU
+
+typedef struct mc_outbuf {
+    unsigned char *buf;   /* malloc'd buffer, or mapping of file */
+    size_t len, alloc;    /* bytes used, bytes allocated */
+    int fd;               /* file descriptor of file, or -1 if not used */
+    const char *file;     /* name of file to use if needed */
+    SEXP what;            /* object to serialize */
+} mc_outbuf_t;
+
+static void mc_outbuf_free(mc_outbuf_t *ob)
+{
+    if (ob->fd < 0) 
+	free(ob->buf);
+    else {
+	if (ob->buf != MAP_FAILED) munmap(ob->buf, ob->alloc);
+	close(ob->fd);
+    }
+    ob->buf = NULL;
+}
+
+/* Make room for n more bytes, switching to a mapped file if the total
+   would exceed MC_SHARED_MIN, and growing the file as needed. */
+
+static void mc_outbuf_room(mc_outbuf_t *ob, size_t n)
+{
+    size_t alloc;
+    unsigned char *b;
+
+    if (ob->len + n <= ob->alloc) return;
+
+    alloc = 2*ob->alloc + n;
+
+    if (ob->fd < 0 && ob->len + n <= MC_SHARED_MIN) {
+	if (alloc > MC_SHARED_MIN) alloc = MC_SHARED_MIN;
+	b = realloc(ob->buf, alloc);
+	if (b == NULL) error(_("memory allocation error"));
+	ob->buf = b;
+	ob->alloc = alloc;
+	return;
+    }
+
+    if (ob->fd < 0) {
+	int fd = open(ob->file, O_RDWR | O_CREAT | O_EXCL, 0600);
+	if (fd < 0)
+	    error(_("unable to create file for result: %s"), strerror(errno));
+	b = ftruncate(fd, alloc) != 0 ? MAP_FAILED 
+	      : mmap(NULL, alloc, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+	if (b == MAP_FAILED) {
+	    close(fd);
+	    unlink(ob->file);
+	    error(_("unable to map file for result: %s"), strerror(errno));
+	}
+	memcpy(b, ob->buf, ob->len);
+	free(ob->buf);
+	ob->fd = fd;
+    }
+    else {
+	munmap(ob->buf, ob->alloc);
+	ob->buf = MAP_FAILED;
+	if (ftruncate(ob->fd, alloc) != 0)
+	    error(_("unable to extend file for result: %s"), strerror(errno));
+	b = mmap(NULL, alloc, PROT_READ | PROT_WRITE, MAP_SHARED, ob->fd, 0);
+	if (b == MAP_FAILED)
+	    error(_("unable to map file for result: %s"), strerror(errno));
+    }
+
+    ob->buf = b;
+    ob->alloc = alloc;
+}
+
+static void mc_out_bytes(R_outpstream_t stream, void *buf, int length)
+{
+    mc_outbuf_t *ob = stream->data;
+    mc_outbuf_room(ob, length);
+    memcpy(ob->buf + ob->len, buf, length);
+    ob->len += length;
+}
+
+static void mc_out_char(R_outpstream_t stream, int c)
+{
+    unsigned char b = (unsigned char) c;
+    mc_out_bytes(stream, &b, 1);
+}
+
+static void mc_serialize(void *data)
+{
+    mc_outbuf_t *ob = data;
+    struct R_outpstream_st out;
+    R_InitOutPStream(&out, (R_pstream_data_t) ob, R_pstream_binary_format, 0,
+		     mc_out_char, mc_out_bytes, NULL, R_NilValue);
+    R_Serialize(ob->what, &out);
+}
+
+static int read_all(int fd, void *buf, size_t len)
+{
+    size_t i = 0;
+    while (i < len) {
+	ssize_t n = read(fd, (char *) buf + i, len - i);
+	if (n < 1) return 0;
+	i += n;
+    }
+    return 1;
+}
+
+static int write_all(int fd, const void *buf, size_t len)
+{
+    size_t i = 0;
+    while (i < len) {
+	ssize_t n = write(fd, (const char *) buf + i, len - i);
+	if (n < 1) return 0;
+	i += n;
+    }
+    return 1;
+}
+
+SEXP mc_send_master_value(SEXP what, SEXP sFile)
+{
+    mc_outbuf_t ob;
+    int ok;
+
+    if (is_master)
+	error(_("only children can send data to the master process"));
+    if (master_fd == -1) 
+	error(_("there is no pipe to the master process"));
+    if (!isString(sFile) || LENGTH(sFile) != 1)
+	error(_("invalid '%s' argument"), "file");
+
+    ob.buf = NULL;
+    ob.len = ob.alloc = 0;
+    ob.fd = -1;
+    ob.file = translateChar(STRING_ELT(sFile, 0));
+    ob.what = what;
+
+    if (!R_ToplevelExec(mc_serialize, &ob)) {
+	mc_outbuf_free(&ob);
+	if (ob.fd >= 0) unlink(ob.file);
+	error(_("unable to serialize result"));
+    }
+
+#ifdef MC_DEBUG
+    Dprintf("child %d: send_master_value (%lu bytes%s)\n", getpid(), 
+	    (unsigned long) ob.len, ob.fd < 0 ? "" : ", shared");
+#endif
+
+    if (ob.fd < 0) {
+	unsigned int len = ob.len;
+	ok = write_all(master_fd, &len, sizeof(len))
+	       && write_all(master_fd, ob.buf, ob.len);
+    }
+    else {
+	unsigned int len = MC_SHARED_LEN, flen = strlen(ob.file);
+	ok = write_all(master_fd, &len, sizeof(len))
+	       && write_all(master_fd, &ob.len, sizeof(ob.len))
+	       && write_all(master_fd, &flen, sizeof(flen))
+	       && write_all(master_fd, ob.file, flen);
+	if (!ok) unlink(ob.file);
+    }
+
+    mc_outbuf_free(&ob);
+
+    if (!ok) {
+	close(master_fd);
+	master_fd = -1;
+	error(_("write error, closing pipe to the master"));
+    }
+
+    return ScalarLogical(1);
+}
+
 SEXP mc_send_child_stdin(SEXP sPid, SEXP what) 
 {
     unsigned char *b;
@@ -268,6 +455,118 @@ SEXP mc_send_child_stdin(SEXP sPid, SEXP what)
     return ScalarLogical(1);
 }
 
+/* Tasks for workers in a pool are sent to the child's stdin as a raw
+   vector (serialized by the caller) preceded by its length. */
+
+SEXP mc_send_task(SEXP sPid, SEXP what)
+{
+    unsigned int len;
+    int pid = asInteger(sPid);
+    child_info_t *ci = children;
+    if (!is_master) 
+	error(_("only the master process can send data to a child process"));
+    if (TYPEOF(what) != RAWSXP) error(_("what must be a raw vector"));
+    while (ci) {
+	if (ci->pid == pid) break;
+	ci = ci -> next;
+    }
+    if (!ci) error(_("child %d does not exist"), pid);
+    len = LENGTH(what);
+    if (!write_all(ci->sifd, &len, sizeof(len))
+          || !write_all(ci->sifd, RAW(what), len))
+	error(_("write error"));
+    return ScalarLogical(1);
+}
+
+/* Read a task sent by mc_send_task, returning NULL if the master has 
+   closed the pipe. */
+
+SEXP mc_read_task(void)
+{
+    unsigned int len;
+    SEXP rv;
+    if (is_master) error(_("only children can read tasks"));
+    if (!read_all(STDIN_FILENO, &len, sizeof(len)))
+	return R_NilValue;
+    rv = allocVector(RAWSXP, len);
+    if (!read_all(STDIN_FILENO, RAW(rv), len))
+	return R_NilValue;
+    return rv;
+}
+
+/* Fingerprints of the bindings in the global environment of the given 
+   names, used to decide whether workers in a pool, which see bindings as
+   they were when forked, are out of date.  The fingerprint is a hash of
+   the serialization of the object bound, computed as it is written out,
+   without storing it.  (The address of the object can't be used, since
+   the space of an object that is garbage collected may be reused for a
+   new one.)  The fingerprint is NA if the name is not bound. */
+
+static uint64_t mc_mix(uint64_t x)
+{
+    x ^= x >> 31;
+    x *= 0x7fb5d329728ea185ULL;
+    x ^= x >> 27;
+    x *= 0x81dadef4bc2dd44dULL;
+    x ^= x >> 33;
+    return x;
+}
+
+static void mc_hash_char(R_outpstream_t stream, int c)
+{
+    uint64_t *h = stream->data;
+    *h = mc_mix(*h + (unsigned char) c);
+}
+
+static void mc_hash_bytes(R_outpstream_t stream, void *buf, int length)
+{
+    uint64_t *h = stream->data, w;
+    const unsigned char *p = buf;
+
+    for ( ; length >= sizeof w; length -= sizeof w, p += sizeof w) {
+        memcpy(&w, p, sizeof w);
+        *h = mc_mix(*h + w);
+    }
+    for ( ; length > 0; length--, p++)
+        *h = mc_mix(*h + *p);
+}
+
+static uint64_t mc_hash_binding(SEXP sym, SEXP v)
+{
+    struct R_outpstream_st out;
+    uint64_t h = mc_mix((uintptr_t) sym);
+
+    R_InitOutPStream(&out, (R_pstream_data_t) &h, R_pstream_binary_format,
+                     2, mc_hash_char, mc_hash_bytes, NULL, R_NilValue);
+    R_Serialize(v, &out);
+
+    return mc_mix(h);
+}
+
+SEXP mc_global_state(SEXP names)
+{
+    char buf[20];
+    SEXP res;
+    int i;
+
+    if (!isString(names)) error(_("invalid '%s' argument"), "names");
+
+    PROTECT(res = allocVector(STRSXP, LENGTH(names)));
+    for (i = 0; i < LENGTH(names); i++) {
+	SEXP sym = install(translateChar(STRING_ELT(names, i)));
+	SEXP v = findVarInFrame(R_GlobalEnv, sym);
+	if (v == R_UnboundValue)
+	    SET_STRING_ELT(res, i, NA_STRING);
+	else {
+	    sprintf(buf, "%016llx", 
+		    (unsigned long long) mc_hash_binding(sym, v));
+	    SET_STRING_ELT(res, i, mkChar(buf));
+	}
+    }
+    UNPROTECT(1);
+    return res;
+}
+
 SEXP mc_select_children(SEXP sTimeout, SEXP sWhich) 
 {
     int maxfd = 0, sr, zombies = 0;
@@ -373,22 +672,112 @@ SEXP mc_select_children(SEXP sTimeout, SEXP sWhich)
     return res;
 }
 
+/* Unserialize a value sent through a file by mc_send_master_value. */
+
+typedef struct mc_inbuf {
+    unsigned char *buf;
+    size_t len, pos;
+    SEXP value;
+} mc_inbuf_t;
+
+static void mc_in_bytes(R_inpstream_t stream, void *buf, int length)
+{
+    mc_inbuf_t *ib = stream->data;
+    if ((size_t) length > ib->len - ib->pos)
+	error(_("read error"));
+    memcpy(buf, ib->buf + ib->pos, length);
+    ib->pos += length;
+}
+
+static int mc_in_char(R_inpstream_t stream)
+{
+    unsigned char b;
+    mc_in_bytes(stream, &b, 1);
+    return b;
+}
+
+static void mc_unserialize(void *data)
+{
+    mc_inbuf_t *ib = data;
+    struct R_inpstream_st in;
+    R_InitInPStream(&in, (R_pstream_data_t) ib, R_pstream_any_format,
+		    mc_in_char, mc_in_bytes, NULL, R_NilValue);
+    ib->value = R_Unserialize(&in);
+}
+
+/* Read the size and name of the file for a value sent through a file,
+   and return the value, in a list with class "sharedResult", or 
+   R_NilValue if the size and name couldn't be read.  The file is deleted
+   once it has been opened. */
+
+static SEXP read_child_shared(child_info_t *ci)
+{
+    char file[PATH_MAX+1];
+    unsigned int flen;
+    mc_inbuf_t ib;
+    SEXP rv;
+    int fd, ok;
+
+    if (!read_all(ci->pfd, &ib.len, sizeof(ib.len))
+          || !read_all(ci->pfd, &flen, sizeof(flen)) || flen > PATH_MAX
+          || !read_all(ci->pfd, file, flen))
+	return R_NilValue;
+    file[flen] = 0;
+
+#ifdef MC_DEBUG
+    Dprintf(" read_child_shared(%d) - %lu bytes in %s\n", ci->pid, 
+	    (unsigned long) ib.len, file);
+#endif
+
+    fd = open(file, O_RDONLY);
+    if (fd < 0)
+	error(_("unable to open file for result: %s"), strerror(errno));
+    unlink(file);
+    ib.buf = mmap(NULL, ib.len, PROT_READ, MAP_SHARED, fd, 0);
+    close(fd);
+    if (ib.buf == MAP_FAILED)
+	error(_("unable to map file for result: %s"), strerror(errno));
+    ib.pos = 0;
+    ib.value = R_NilValue;
+
+    ok = R_ToplevelExec(mc_unserialize, &ib);
+    munmap(ib.buf, ib.len);
+    if (!ok)
+	error(_("unable to unserialize result from child %d"), ci->pid);
+
+    PROTECT(ib.value);
+    rv = allocVector(VECSXP, 1);
+    SET_VECTOR_ELT(rv, 0, ib.value);
+    UNPROTECT(1);
+    return rv;
+}
+
 static SEXP read_child_ci(child_info_t *ci) 
 {
     unsigned int len = 0;
     int fd = ci->pfd;
     int n = read(fd, &len, sizeof(len));
+    SEXP rv;
 #ifdef MC_DEBUG
     Dprintf(" read_child_ci(%d) - read length returned %d\n", ci->pid, n);
 #endif
-    if (n != sizeof(len) || len == 0) { /* error or child is exiting */
+    if (n == sizeof(len) && len == MC_SHARED_LEN
+          && (rv = read_child_shared(ci)) != R_NilValue) {
+	PROTECT(rv);
+	setAttrib(rv, install("pid"), ScalarInteger(ci->pid));
+	setAttrib(rv, R_ClassSymbol, mkString("sharedResult"));
+	UNPROTECT(1);
+	return rv;
+    }
+    if (n != sizeof(len) || len == 0 || len == MC_SHARED_LEN) {
+	/* error or child is exiting */
 	int pid = ci->pid;
 	close(fd);
 	ci->pfd = -1;
 	rm_child_(pid);
 	return ScalarInteger(pid);
     } else {
-	SEXP rv = allocVector(RAWSXP, len);
+	rv = allocVector(RAWSXP, len);
 	unsigned char *rvb = RAW(rv);
 	unsigned int i = 0;
 	while (i < len) {
@@ -39,8 +39,12 @@ static const R_CallMethodDef callMethods[] = {
     {"mc_read_children", (DL_FUNC) &mc_read_children, 1},
     {"mc_rm_child", (DL_FUNC) &mc_rm_child, 1},
     {"mc_send_master", (DL_FUNC) &mc_send_master, 1},
+    {"mc_send_master_value", (DL_FUNC) &mc_send_master_value, 2},
     {"mc_select_children", (DL_FUNC) &mc_select_children, 2},
     {"mc_send_child_stdin", (DL_FUNC) &mc_send_child_stdin, 2},
+    {"mc_send_task", (DL_FUNC) &mc_send_task, 2},
+    {"mc_read_task", (DL_FUNC) &mc_read_task, 0},
+    {"mc_global_state", (DL_FUNC) &mc_global_state, 1},
 #else
     {"ncpus", (DL_FUNC) &ncpus, 1},
 #endif
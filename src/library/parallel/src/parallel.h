@@ -47,8 +47,12 @@ SEXP mc_read_child(SEXP);
 SEXP mc_read_children(SEXP);
 SEXP mc_rm_child(SEXP);
 SEXP mc_send_master(SEXP);
+SEXP mc_send_master_value(SEXP, SEXP);
 SEXP mc_select_children(SEXP, SEXP);
 SEXP mc_send_child_stdin(SEXP, SEXP);
+SEXP mc_send_task(SEXP, SEXP);
+SEXP mc_read_task(void);
+SEXP mc_global_state(SEXP);
 #else
 SEXP ncpus(SEXP);
 #endif
@@ -52,6 +52,20 @@ static double R_euclidean(double *x, int nr, int nc, int i1, int i2)
     double dev, dist;
     int na_count, j;
 
+    /* Try first without checking for NA/NaN, which is faster, and gives 
+       the same result if there are none.  Otherwise, redo the computation. */
+
+    if (nr == 1) {
+        double *x1 = x + i1, *x2 = x + i2;
+        dist = 0;
+        for (j = 0; j < nc; j++) {
+            dev = x1[j] - x2[j];
+            dist += dev * dev;
+        }
+        if (!ISNAN(dist))
+            return sqrt(dist);
+    }
+
     na_count= 0;
     dist = 0;
     for (j = 0; j < nc; j++) {
@@ -92,6 +106,17 @@ static double R_manhattan(double *x, int nr, int nc, int i1, int i2)
     double dev, dist;
     int na_count, j;
 
+    /* Try first without checking for NA/NaN, as for R_euclidean. */
+
+    if (nr == 1) {
+        double *x1 = x + i1, *x2 = x + i2;
+        dist = 0;
+        for (j = 0; j < nc; j++)
+            dist += fabs(x1[j] - x2[j]);
+        if (!ISNAN(dist))
+            return dist;
+    }
+
     na_count = 0;
     dist = 0;
     for (j = 0; j < nc; j++) {
@@ -198,6 +223,39 @@ static double R_minkowski(double *x, int nr, int nc, int i1, int i2, double p)
 enum { EUCLIDEAN=1, MAXIMUM, MANHATTAN, CANBERRA, BINARY, MINKOWSKI };
 /* == 1,2,..., defined by order in the R function dist */
 
+/* Distance between rows i1 and i2, for method meth.  The matrix is stored
+   with a stride of nr between elements in a row. */
+
+static double R_dist_pair(int meth, double *x, int nr, int nc, 
+                          int i1, int i2, double p)
+{
+    switch (meth) {
+    case EUCLIDEAN: return R_euclidean (x, nr, nc, i1, i2);
+    case MAXIMUM:   return R_maximum (x, nr, nc, i1, i2);
+    case MANHATTAN: return R_manhattan (x, nr, nc, i1, i2);
+    case CANBERRA:  return R_canberra (x, nr, nc, i1, i2);
+    case BINARY:    return R_dist_binary (x, nr, nc, i1, i2);
+    default:        return R_minkowski (x, nr, nc, i1, i2, p);
+    }
+}
+
+/* Number of elements of a row-block of the transposed matrix, chosen so 
+   that the two row-blocks used for one tile of distances stay in cache. */
+
+#define DIST_BLOCK_ELEMENTS 8192
+
+/* Compute distances between rows of x, storing the lower triangle of the
+   distance matrix in d, by columns.
+
+   When there are many rows, the rows of x are accessed with a large
+   stride, so x is first transposed, after which the elements of a row are
+   contiguous.  Distances are then computed for tiles of the lower 
+   triangle, with the rows for one tile being small enough to stay in 
+   cache.  Distances are still computed with the same operations in the 
+   same order, so the results are identical to computing them directly.  
+   Tiles may be done in parallel, with OpenMP, when R_num_math_threads is 
+   greater than one (except for the binary method, which may warn). */
+
 void R_distance(double *x, int *nr, int *nc, double *d, int *diag,
                 int *method, double *p)
 {
@@ -210,45 +268,57 @@ void R_distance(double *x, int *nr, int *nc, double *d, int *diag,
     size_t ij;  /* can exceed 2^31 - 1 */
     R_len_t i, j;
 
-    ij = 0;
-
     if (meth == MINKOWSKI && pv == 2.0) meth = EUCLIDEAN;
 
-    switch (meth) {
-    case EUCLIDEAN:
-        for (j = 0; j <= nrow; j++)
-            for (i = j+dc; i < nrow; i++)
-                d[ij++] = R_euclidean (x, nrow, ncol, i, j);
-        break;
-    case MAXIMUM:
-        for (j = 0; j <= nrow; j++)
-            for (i = j+dc; i < nrow; i++)
-                d[ij++] = R_maximum (x, nrow, ncol, i, j);
-        break;
-    case MANHATTAN:
-        for (j = 0; j <= nrow; j++)
-            for (i = j+dc; i < nrow; i++)
-                d[ij++] = R_manhattan (x, nrow, ncol, i, j);
-        break;
-    case CANBERRA:
-        for (j = 0; j <= nrow; j++)
-            for (i = j+dc; i < nrow; i++)
-                d[ij++] = R_canberra (x, nrow, ncol, i, j);
-        break;
-    case BINARY:
-        for (j = 0; j <= nrow; j++)
-            for (i = j+dc; i < nrow; i++)
-                d[ij++] = R_dist_binary (x, nrow, ncol, i, j);
-        break;
-    case MINKOWSKI:
-        if (!R_FINITE(pv) || pv <= 0)
-            error(_("distance(): invalid p"));
-        for (j = 0; j <= nrow; j++)
-            for (i = j+dc; i < nrow; i++)
-                d[ij++] = R_minkowski (x, nrow, ncol, i, j, pv);
-        break;
-    default:
+    if (meth < EUCLIDEAN || meth > MINKOWSKI)
         error(_("distance(): invalid distance"));
+    if (meth == MINKOWSKI && (!R_FINITE(pv) || pv <= 0))
+        error(_("distance(): invalid p"));
+
+    if (nrow <= 2 || ncol <= 1) {
+        ij = 0;
+        for (j = 0; j < nrow; j++)
+            for (i = j+dc; i < nrow; i++)
+                d[ij++] = R_dist_pair (meth, x, nrow, ncol, i, j, pv);
+        return;
+    }
+
+    /* Transpose x, so each row is contiguous. */
+
+    double *xt = (double *) R_alloc ((size_t) nrow * ncol, sizeof(double));
+    for (j = 0; j < ncol; j++) {
+        double *xj = x + (size_t) j * nrow;
+        for (i = 0; i < nrow; i++)
+            xt[(size_t) i * ncol + j] = xj[i];
+    }
+
+    /* Compute the distances in tiles of blk by blk rows. */
+
+    R_len_t blk = DIST_BLOCK_ELEMENTS / ncol;
+    if (blk < 1) blk = 1;
+    R_len_t nblk = (nrow + blk - 1) / blk;
+    R_len_t jb;
+
+#ifdef HAVE_OPENMP
+    int nthreads = 1;
+    if (R_num_math_threads > 1 && meth != BINARY)
+        nthreads = R_num_math_threads;
+#pragma omp parallel for num_threads(nthreads) schedule(dynamic) \
+    private(i, j, ij) firstprivate(nrow, ncol, dc, meth, pv, blk, nblk, xt, d)
+#endif
+    for (jb = 0; jb < nblk; jb++) {
+        R_len_t j0 = jb * blk, j1 = j0 + blk > nrow ? nrow : j0 + blk;
+        R_len_t i0, i1;
+        for (i0 = j0; i0 < nrow; i0 += blk) {
+            i1 = i0 + blk > nrow ? nrow : i0 + blk;
+            for (j = j0; j < j1; j++) {
+                /* index in d of distance for (i,j) is ij + i */
+                ij = (size_t) j * (nrow-dc) - (size_t) j * (j+1) / 2 - dc;
+                for (i = i0 > j+dc ? i0 : j+dc; i < i1; i++)
+                    d[ij+i] = R_dist_pair (meth, xt, 1, ncol, 
+                                           i*ncol, j*ncol, pv);
+            }
+        }
     }
 }
 
@@ -17,38 +17,107 @@
  *  http://www.r-project.org/Licenses/
  */
 
+#ifdef HAVE_CONFIG_H
+# include <config.h>
+#endif
+
 #include <R.h>
 #include "modreg.h" /* for declarations for registration */
+#ifdef HAVE_OPENMP
+# include <R_ext/MathThreads.h>
+#endif
+
+/* The Lloyd and MacQueen methods work with a copy of the data transposed, 
+   so that the coordinates of a point are contiguous, and with the centres
+   stored the same way, since otherwise access to both has a large stride.
+   Squared distances are computed with the same operations in the same 
+   order as the straightforward code, so results are unchanged. */
+
+static double *transposed (double *x, int n, int p)
+{
+    double *xt = (double *) R_alloc ((size_t) n * p, sizeof(double));
+    int i, c;
+
+    for (c = 0; c < p; c++)
+        for (i = 0; i < n; i++)
+            xt[(size_t) i * p + c] = x[i + (size_t) n * c];
+
+    return xt;
+}
+
+static void untranspose (double *xt, int n, int p, double *x)
+{
+    int i, c;
+
+    for (c = 0; c < p; c++)
+        for (i = 0; i < n; i++)
+            x[i + (size_t) n * c] = xt[(size_t) i * p + c];
+}
+
+/* Find the centre nearest to the point xi (index from 0), returning inew if
+   no centre is at distance less than infinity.  (Stopping accumulation of
+   a squared distance once it exceeds the best so far turns out to be 
+   slower, for moderate numbers of coordinates.) */
+
+static int nearest_centre (double *xi, double *ct, int k, int p, int inew)
+{
+    double best = R_PosInf;
+    int j, c;
+
+    for (j = 0; j < k; j++) {
+        double *cj = ct + (size_t) j * p;
+        double dd = 0.0;
+        for (c = 0; c < p; c++) {
+            double tmp = xi[c] - cj[c];
+            dd += tmp * tmp;
+        }
+        if (dd < best) {
+            best = dd;
+            inew = j;
+        }
+    }
+
+    return inew;
+}
+
+/* Number of points handled together in the assignment step of Lloyd's
+   method, which may be done in parallel for different blocks. */
+
+#define KMEANS_BLOCK 256
 
 void kmeans_Lloyd(double *x, int *pn, int *pp, double *cen, int *pk, int *cl,
 		  int *pmaxiter, int *nc, double *wss)
 {
     int n = *pn, k = *pk, p = *pp, maxiter = *pmaxiter;
-    int iter, i, j, c, it, inew = 0;
-    double best, dd, tmp;
-    Rboolean updated;
+    int iter, i, j, c, it, ib;
+    double tmp;
+    int updated;
+
+    double *xt = transposed (x, n, p);
+    double *ct = (double *) R_alloc ((size_t) k * p, sizeof(double));
 
     for(i = 0; i < n; i++) cl[i] = -1;
     for(iter = 0; iter < maxiter; iter++) {
 	updated = FALSE;
-	for(i = 0; i < n; i++) {
-	    /* find nearest centre for each point */
-	    best = R_PosInf;
-	    for(j = 0; j < k; j++) {
-		dd = 0.0;
-		for(c = 0; c < p; c++) {
-		    tmp = x[i+n*c] - cen[j+k*c];
-		    dd += tmp * tmp;
-		}
-		if(dd < best) {
-		    best = dd;
-		    inew = j+1;
+	/* find nearest centre for each point, perhaps in parallel, which
+	   doesn't affect the results */
+	for(j = 0; j < k; j++)
+	    for(c = 0; c < p; c++) ct[(size_t) j * p + c] = cen[j+k*c];
+#ifdef HAVE_OPENMP
+	int nthreads = R_num_math_threads > 1 ? R_num_math_threads : 1;
+#pragma omp parallel for num_threads(nthreads) schedule(static) \
+    private(i) reduction(|:updated)
+#endif
+	for(ib = 0; ib < n; ib += KMEANS_BLOCK) {
+	    int iend = ib + KMEANS_BLOCK < n ? ib + KMEANS_BLOCK : n;
+	    int inew = 0;
+	    for(i = ib; i < iend; i++) {
+		inew = nearest_centre (xt + (size_t) i * p, ct, k, p, inew);
+		if(cl[i] != inew+1) {
+		    updated = TRUE;
+		    cl[i] = inew+1;
 		}
 	    }
-	    if(cl[i] != inew) {
-		updated = TRUE;
-		cl[i] = inew;
-	    }
 	}
 	if(!updated) break;
 	/* update each centre */
@@ -77,63 +146,49 @@ void kmeans_MacQueen(double *x, int *pn, int *pp, double *cen, int *pk,
 {
     int n = *pn, k = *pk, p = *pp, maxiter = *pmaxiter;
     int iter, i, j, c, it, inew = 0, iold;
-    double best, dd, tmp;
+    double tmp;
     Rboolean updated;
 
+    double *xt = transposed (x, n, p);
+    double *ct = transposed (cen, k, p);
+
     /* first assign each point to the nearest cluster centre */
     for(i = 0; i < n; i++) {
-	best = R_PosInf;
-	for(j = 0; j < k; j++) {
-	    dd = 0.0;
-	    for(c = 0; c < p; c++) {
-		tmp = x[i+n*c] - cen[j+k*c];
-		dd += tmp * tmp;
-	    }
-	    if(dd < best) {
-		best = dd;
-		inew = j+1;
-	    }
-	}
-	if(cl[i] != inew) cl[i] = inew;
+	inew = nearest_centre (xt + (size_t) i * p, ct, k, p, inew);
+	if(cl[i] != inew+1) cl[i] = inew+1;
     }
    /* and recompute centres as centroids */
-    for(j = 0; j < k*p; j++) cen[j] = 0.0;
+    for(j = 0; j < k*p; j++) ct[j] = 0.0;
     for(j = 0; j < k; j++) nc[j] = 0;
     for(i = 0; i < n; i++) {
 	it = cl[i] - 1; nc[it]++;
-	for(c = 0; c < p; c++) cen[it+c*k] += x[i+c*n];
+	for(c = 0; c < p; c++) ct[(size_t) it*p+c] += xt[(size_t) i*p+c];
     }
-    for(j = 0; j < k*p; j++) cen[j] /= nc[j % k];
+    for(j = 0; j < k; j++)
+	for(c = 0; c < p; c++) ct[(size_t) j*p+c] /= nc[j];
 
     for(iter = 0; iter < maxiter; iter++) {
 	updated = FALSE;
 	for(i = 0; i < n; i++) {
-	    best = R_PosInf;
-	    for(j = 0; j < k; j++) {
-		dd = 0.0;
-		for(c = 0; c < p; c++) {
-		    tmp = x[i+n*c] - cen[j+k*c];
-		    dd += tmp * tmp;
-		}
-		if(dd < best) {
-		    best = dd;
-		    inew = j;
-		}
-	    }
+	    double *xi = xt + (size_t) i * p;
+	    inew = nearest_centre (xi, ct, k, p, inew);
 	    if((iold = cl[i] - 1) != inew) {
+		double *co = ct + (size_t) iold * p, *cn = ct + (size_t) inew * p;
 		updated = TRUE;
 		cl[i] = inew + 1;
 		nc[iold]--; nc[inew]++;
 		/* update old and new cluster centres */
 		for(c = 0; c < p; c++) {
-		    cen[iold+k*c] += (cen[iold+k*c] - x[i+n*c])/nc[iold];
-		    cen[inew+k*c] += (x[i+n*c] - cen[inew+k*c])/nc[inew];
+		    co[c] += (co[c] - xi[c])/nc[iold];
+		    cn[c] += (xi[c] - cn[c])/nc[inew];
 		}
 	    }
 	}
 	if(!updated) break;
     }
 
+    untranspose (ct, k, p, cen);
+
     *pmaxiter = iter + 1;
     for(j = 0; j < k; j++) wss[j] = 0.0;
     for(i = 0; i < n; i++) {
@@ -17,9 +17,17 @@
  *  http://www.r-project.org/Licenses/.
  */
 
+#ifdef HAVE_CONFIG_H
+# include <config.h>
+#endif
+
 #include <R.h>
 #include <Rinternals.h>
 #include <R_ext/Applic.h>
+#ifdef HAVE_OPENMP
+# include <R_ext/MathThreads.h>
+# include <omp.h>
+#endif
 
 /* A wrapper to replace
 
@@ -105,3 +113,177 @@ SEXP Cdqrls(SEXP x, SEXP y, SEXP tol)
     
     return ans;
 }
+
+
+/* Fit separate least squares regressions for groups of rows of x and y,
+   as if by Cdqrls applied to x[g==i,,drop=FALSE] and y[g==i] (or the rows
+   of y, if a matrix), for i from 1 to the number of levels of the factor 
+   g (rows where g is NA are ignored).  The result is a list with an 
+   element for each level, which is NULL if there are no rows in the
+   group, and otherwise like the result of Cdqrls, except that the "qr",
+   "residuals", and "effects" components have no attributes other than
+   dimensions.
+
+   All the results are allocated first, after which the fits are done 
+   without any further allocation, in parallel with OpenMP if the number
+   of math threads has been set to more than one (each thread using its
+   own workspace), and then the ranks are filled in.  Groups are fitted 
+   independently, so the results don't depend on the number of threads. */
+
+SEXP Cdqrls_grouped(SEXP x, SEXP y, SEXP g, SEXP tol)
+{
+    SEXP ans, ansnames, fit, qr, coefficients, residuals, effects, pivot;
+    int n, ny, p, ng, nprotect = 2;
+    double rtol = asReal(tol);
+
+    if (!isMatrix(x))
+	error("'x' must be a matrix");
+    int *dims = INTEGER(getAttrib(x, R_DimSymbol));
+    n = dims[0]; p = dims[1];
+    if (n == 0)
+	error("0 (non-NA) cases");
+    ny = LENGTH(y)/n;  /* n x ny, or a vector */
+    ng = LENGTH(getAttrib(g, R_LevelsSymbol));
+
+    if (TYPEOF(g) != INTSXP || LENGTH(g) != n)
+	error("invalid grouping factor");
+    if (TYPEOF(x) != REALSXP) {
+	PROTECT(x = coerceVector(x, REALSXP)); 
+	nprotect++;
+    }
+    if (TYPEOF(y) != REALSXP) {
+	PROTECT(y = coerceVector(y, REALSXP));
+	nprotect++;
+    }
+
+    double *xp = REAL(x), *yp = REAL(y);
+    int *gp = INTEGER(g);
+
+    for (int i = 0 ; i < LENGTH(x) ; i++)
+	if(!R_FINITE(xp[i])) error("NA/NaN/Inf in 'x'");
+    for (int i = 0 ; i < LENGTH(y) ; i++)
+	if(!R_FINITE(yp[i])) error("NA/NaN/Inf in 'y'");
+
+    /* Find the number of rows in each group. */
+
+    int *cnt = (int *) R_alloc(ng, sizeof(int));
+    for (int k = 0; k < ng; k++) cnt[k] = 0;
+    for (int i = 0; i < n; i++) {
+	if (gp[i] == NA_INTEGER) continue;
+	if (gp[i] < 1 || gp[i] > ng) error("invalid grouping factor");
+	cnt[gp[i]-1] += 1;
+    }
+
+    /* Allocate the results, copying in the rows of x and y for each group. */
+
+    PROTECT(ansnames = allocVector(STRSXP, 9));
+    SET_STRING_ELT(ansnames, 0, mkChar("qr"));
+    SET_STRING_ELT(ansnames, 1, mkChar("coefficients"));
+    SET_STRING_ELT(ansnames, 2, mkChar("residuals"));
+    SET_STRING_ELT(ansnames, 3, mkChar("effects"));
+    SET_STRING_ELT(ansnames, 4, mkChar("rank"));
+    SET_STRING_ELT(ansnames, 5, mkChar("pivot"));
+    SET_STRING_ELT(ansnames, 6, mkChar("qraux"));
+    SET_STRING_ELT(ansnames, 7, mkChar("tol"));
+    SET_STRING_ELT(ansnames, 8, mkChar("pivoted"));
+
+    PROTECT(ans = allocVector(VECSXP, ng));
+    setAttrib(ans, R_NamesSymbol, getAttrib(g, R_LevelsSymbol));
+
+    double **gx = (double **) R_alloc(ng, sizeof(double *));
+    double **gy = (double **) R_alloc(ng, sizeof(double *));
+    int *gi = (int *) R_alloc(ng, sizeof(int));
+    size_t ntot = 0;
+    for (int k = 0; k < ng; k++) ntot += cnt[k];
+    double *ybuf = (double *) R_alloc(ntot * ny, sizeof(double));
+
+    for (int k = 0; k < ng; k++) {
+	int m = cnt[k];
+	if (m == 0) continue;
+	fit = allocVector(VECSXP, 9);
+	SET_VECTOR_ELT(ans, k, fit);
+	setAttrib(fit, R_NamesSymbol, ansnames);
+	SET_VECTOR_ELT(fit, 0, qr = allocMatrix(REALSXP, m, p));
+	gx[k] = REAL(qr);
+	if (ny > 1) coefficients = allocMatrix(REALSXP, p, ny);
+	else coefficients = allocVector(REALSXP, p);
+	SET_VECTOR_ELT(fit, 1, coefficients);
+	if (ny > 1) residuals = allocMatrix(REALSXP, m, ny);
+	else residuals = allocVector(REALSXP, m);
+	SET_VECTOR_ELT(fit, 2, residuals);
+	SET_VECTOR_ELT(fit, 3, effects = allocVector(REALSXP, LENGTH(residuals)));
+	if (ny > 1) setAttrib(effects, R_DimSymbol, getAttrib(residuals, 
+	                                                      R_DimSymbol));
+	gy[k] = ybuf;
+	ybuf += (size_t) m * ny;
+	SET_VECTOR_ELT(fit, 5, pivot = allocVector(INTSXP, p));
+	for (int j = 0; j < p; j++) INTEGER(pivot)[j] = j+1;
+	SET_VECTOR_ELT(fit, 6, allocVector(REALSXP, p));
+	SET_VECTOR_ELT(fit, 7, tol);
+    }
+
+    for (int k = 0; k < ng; k++) gi[k] = 0;
+    for (int i = 0; i < n; i++) {
+	if (gp[i] == NA_INTEGER) continue;
+	int k = gp[i]-1, m = cnt[k], r = gi[k]++;
+	for (int j = 0; j < p; j++) 
+	    gx[k][r + (size_t) j*m] = xp[i + (size_t) j*n];
+	for (int j = 0; j < ny; j++) 
+	    gy[k][r + (size_t) j*m] = yp[i + (size_t) j*n];
+    }
+
+    /* Do the fits, recording ranks. */
+
+    int nthreads = 1;
+#ifdef HAVE_OPENMP
+    if (R_num_math_threads > 1) nthreads = R_num_math_threads;
+#endif
+    double *work = (double *) R_alloc((size_t) nthreads * 2 * p, 
+                                      sizeof(double));
+    int *rank = (int *) R_alloc(ng, sizeof(int));
+    double **gcoef = (double **) R_alloc(ng, sizeof(double *));
+    double **gres = (double **) R_alloc(ng, sizeof(double *));
+    double **geff = (double **) R_alloc(ng, sizeof(double *));
+    int **gpiv = (int **) R_alloc(ng, sizeof(int *));
+    double **gqraux = (double **) R_alloc(ng, sizeof(double *));
+    for (int k = 0; k < ng; k++) {
+	if (cnt[k] == 0) continue;
+	fit = VECTOR_ELT(ans, k);
+	gcoef[k] = REAL(VECTOR_ELT(fit, 1));
+	gres[k] = REAL(VECTOR_ELT(fit, 2));
+	geff[k] = REAL(VECTOR_ELT(fit, 3));
+	gpiv[k] = INTEGER(VECTOR_ELT(fit, 5));
+	gqraux[k] = REAL(VECTOR_ELT(fit, 6));
+	/* as duplicate(y) does in Cdqrls, since dqrls doesn't set these
+	   when the rank is zero */
+	memcpy(gres[k], gy[k], (size_t) cnt[k] * ny * sizeof(double));
+	memcpy(geff[k], gy[k], (size_t) cnt[k] * ny * sizeof(double));
+    }
+
+#ifdef HAVE_OPENMP
+#pragma omp parallel for num_threads(nthreads) schedule(dynamic)
+#endif
+    for (int k = 0; k < ng; k++) {
+	int m = cnt[k], t = 0;
+	if (m == 0) continue;
+#ifdef HAVE_OPENMP
+	t = omp_get_thread_num();
+#endif
+	F77_CALL(dqrls)(gx[k], &m, &p, gy[k], &ny, &rtol,
+			gcoef[k], gres[k], geff[k],
+			&rank[k], gpiv[k], gqraux[k], work + (size_t) t*2*p);
+    }
+
+    for (int k = 0; k < ng; k++) {
+	int pivoted = 0;
+	if (cnt[k] == 0) continue;
+	fit = VECTOR_ELT(ans, k);
+	SET_VECTOR_ELT(fit, 4, ScalarInteger(rank[k]));
+	for (int j = 0; j < p; j++)
+	    if (gpiv[k][j] != j+1) { pivoted = 1; break; }
+	SET_VECTOR_ELT(fit, 8, ScalarLogical(pivoted));
+    }
+
+    UNPROTECT(nprotect);
+    return ans;
+}
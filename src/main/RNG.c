@@ -124,6 +124,45 @@ static double fixup(double x)
 }
 
 
+/* One step of L'Ecuyer's MRG32k3a generator, with state in s[0..5].
+   Used both for RNG_kind LECUYER_CMRG and for generating blocks of
+   values from separate streams (see below). */
+
+/* Based loosely on the GPL-ed version of
+   http://www.iro.umontreal.ca/~lecuyer/myftp/streams00/c2010/RngStream.c
+   but using int_least64_t, which C99 guarantees.
+*/
+
+#define m1    4294967087
+#define m2    4294944443
+#define normc  2.328306549295727688e-10
+#define a12     (int_least64_t)1403580
+#define a13n    (int_least64_t)810728
+#define a21     (int_least64_t)527612
+#define a23n    (int_least64_t)1370589
+
+static R_INLINE double lecuyer_unif (Int32 *s)
+{
+    int k;
+    int_least64_t p1, p2;
+
+    p1 = a12 * (unsigned int)s[1] - a13n * (unsigned int)s[0];
+    /* p1 % m1 would surely do */
+    k = p1 / m1;
+    p1 -= k * m1;
+    if (p1 < 0.0) p1 += m1;
+    s[0] = s[1]; s[1] = s[2]; s[2] = p1;
+
+    p2 = a21 * (unsigned int)s[5] - a23n * (unsigned int)s[3];
+    k = p2 / m2;
+    p2 -= k * m2;
+    if (p2 < 0.0) p2 += m2;
+    s[3] = s[4]; s[4] = s[5]; s[5] = p2;
+
+    return ((p1 > p2) ? (p1 - p2) : (p1 - p2 + m1)) * normc;
+}
+
+
 /* This is the uniform(0,1) function called from outside. */
 
 double unif_rand(void)
@@ -164,38 +203,8 @@ double unif_rand(void)
 	return *((double *) User_unif_fun());
 
     case LECUYER_CMRG:
-    {
-	/* Based loosely on the GPL-ed version of
-	   http://www.iro.umontreal.ca/~lecuyer/myftp/streams00/c2010/RngStream.c
-	   but using int_least64_t, which C99 guarantees.
-	*/
-	int k;
-	int_least64_t p1, p2;
-
-#define II(i) i_seed[i]
-#define m1    4294967087
-#define m2    4294944443
-#define normc  2.328306549295727688e-10
-#define a12     (int_least64_t)1403580
-#define a13n    (int_least64_t)810728
-#define a21     (int_least64_t)527612
-#define a23n    (int_least64_t)1370589
+	return lecuyer_unif(i_seed);
 
-	p1 = a12 * (unsigned int)II(1) - a13n * (unsigned int)II(0);
-	/* p1 % m1 would surely do */
-	k = p1 / m1;
-	p1 -= k * m1;
-	if (p1 < 0.0) p1 += m1;
-	II(0) = II(1); II(1) = II(2); II(2) = p1;
-
-	p2 = a21 * (unsigned int)II(5) - a23n * (unsigned int)II(3);
-	k = p2 / m2;
-	p2 -= k * m2;
-	if (p2 < 0.0) p2 += m2;
-	II(3) = II(4); II(4) = II(5); II(5) = p2;
-
-	return ((p1 > p2) ? (p1 - p2) : (p1 - p2 + m1)) * normc;
-    }
     default:
 	error(_("unif_rand: unimplemented RNG kind %d"), RNG_kind);
 	return -1.;
@@ -580,6 +589,90 @@ static SEXP do_setseed (SEXP call, SEXP op, SEXP args, SEXP env)
 }
 
 
+/* SEPARATE STREAMS FOR BLOCKS OF RANDOM VALUES.  When the rng_streams
+   option is TRUE and the generator is L'Ecuyer-CMRG, large vectors of
+   random values are generated in blocks (see random.c), with block b
+   generated from the b'th substream after the current seed.  Substreams
+   are 2^76 values apart, as for nextRNGStream in the parallel package.
+   The blocks may be generated in helper threads, using the procedures
+   below, which don't refer to the global state. */
+
+/* Copy the current seed to seed[0..5] and return TRUE if the generator
+   is L'Ecuyer-CMRG (with the normal kind being Inversion, if norm is
+   TRUE), and otherwise return FALSE.  GetRNGstate must have been called. */
+
+attribute_hidden Rboolean Rf_RNG_stream_seed (Int32 *seed, int norm)
+{
+    if (RNG_kind != LECUYER_CMRG || norm && N01_kind != INVERSION)
+        return FALSE;
+
+    memcpy (seed, i_seed, 6 * sizeof(Int32));
+    return TRUE;
+}
+
+/* Set the current L'Ecuyer-CMRG seed from seed[0..5].  PutRNGstate should 
+   be called afterwards. */
+
+attribute_hidden void Rf_RNG_set_stream_seed (const Int32 *seed)
+{
+    memcpy (i_seed, seed, 6 * sizeof(Int32));
+}
+
+/* Advance the L'Ecuyer-CMRG seed in seed[0..5] to the next substream. */
+
+attribute_hidden void Rf_RNG_next_substream (Int32 *seed)
+{
+    static const uint_least64_t A1p76[3][3] = {
+          {      82758667, 1871391091, 4127413238 }, 
+          {    3672831523,   69195019, 1871391091 }, 
+          {    3672091415, 3528743235,   69195019 }
+          };
+
+    static const uint_least64_t A2p76[3][3] = {
+          {    1511326704, 3759209742, 1610795712 }, 
+          {    4292754251, 1511326704, 3889917532 }, 
+          {    3859662829, 4292754251, 3708466080 }
+          };
+
+    uint_least64_t nseed[6], tmp;
+    int i, j;
+
+    for (i = 0; i < 3; i++) {
+        tmp = 0;
+        for (j = 0; j < 3; j++) {
+            tmp += A1p76[i][j] * (unsigned int) seed[j];
+            tmp %= m1;
+        }
+        nseed[i] = tmp;
+    }
+    for (i = 0; i < 3; i++) {
+        tmp = 0;
+        for (j = 0; j < 3; j++) {
+            tmp += A2p76[i][j] * (unsigned int) seed[j+3];
+            tmp %= m2;
+        }
+        nseed[i+3] = tmp;
+    }
+
+    for (i = 0; i < 6; i++) seed[i] = nseed[i];
+}
+
+/* Store n uniform values from the L'Ecuyer-CMRG stream with state in 
+   seed[0..5] in u[0..n-1], updating the state.  The values are the same 
+   as from n calls of unif_rand with that state. */
+
+attribute_hidden void Rf_RNG_stream_unif (Int32 *seed, double *u, int n)
+{
+    Int32 s[6];
+    int i;
+
+    memcpy (s, seed, sizeof s);
+    for (i = 0; i < n; i++)
+        u[i] = lecuyer_unif(s);
+    memcpy (seed, s, sizeof s);
+}
+
+
 /* S COMPATIBILITY */
 
 /* The following entry points provide compatibility with S. */
@@ -1902,15 +1902,26 @@ static SEXP math1(SEXP sa, unsigned opcode, SEXP call, SEXP env, int variant)
             PROTECT(sy = local_assign || NAMEDCNT_EQ_0(sa) 
                            ? sa : allocVector(REALSXP, n));
 
+            /* Functions that can't produce a warning may be merged with
+               arithmetic and other such functions, in a single task,
+               which is preferred to using two tasks if the operand is
+               still being computed, since it may then be merged into. */
+
+            int merge = R_math1_err_table[opcode] <= 1 
+                         && !helpers_not_merging_now;
+
             if (helpers_not_multithreading_now || LENGTH(sa) < 2*T_math1
-                || R_math1_err_table[opcode] > 1) {
+                || R_math1_err_table[opcode] > 1
+                || merge && helpers_is_being_computed(sa)) {
 
                 /* Use only one task. */
 
                 DO_NOW_OR_LATER1 (variant,
                             LENGTH(sa) >= T_math1 
                               && R_math1_err_table[opcode] <= 1,
-                            HELPERS_PIPE_IN01_OUT,
+                            merge ? HELPERS_PIPE_IN01_OUT | HELPERS_MERGE_IN_OUT
+                                                          | HELPERS_HOLD
+                                  : HELPERS_PIPE_IN01_OUT,
                             task_math1, opcode, sy, sa);
             }
             else {
@@ -1602,49 +1602,51 @@ static SEXP do_aperm(SEXP call, SEXP op, SEXP args, SEXP rho)
     return r;
 }
 
-/* colSums(x, n, p, na.rm) and also the same with "row" and/or "Means". */
-
-void task_colSums_or_colMeans (helpers_op_t op, SEXP ans, SEXP x, SEXP ignored)
+/* colSums(x, n, p, na.rm) and also the same with "row" and/or "Means", plus
+   the other row and column statistics (colMins, rowVars, etc.).  The
+   statistic is the low four bits of PRIMVAL, with bit 4 set for rows. */
+
+#define STAT_SUM   0
+#define STAT_MEAN  1
+#define STAT_MIN   2
+#define STAT_MAX   3
+#define STAT_VAR   4
+#define STAT_SD    5
+#define STAT_ANY   6
+#define STAT_ALL   7
+#define STAT_NAS   8
+
+/* Find sums or means of columns j0 to j1-1 of x, which has n rows, storing
+   them in a[j0] to a[j1-1]. */
+
+static void col_sums (SEXP x, int n, int j0, int j1, double *a,
+                      int keepNA, int Means)
 {
-    int keepNA = op&1;        /* Don't skip NA/NaN elements? */
-    int Means = op&2;         /* Find means rather than sums? */
-    unsigned n = op>>3;       /* Number of rows in matrix */
-    unsigned p = LENGTH(ans); /* Number of columns in matrix */
-    double *a = REAL(ans);    /* Pointer to start of result vector */
-    int np = n*p;             /* Number of elements we need in total */
-    int avail = 0;            /* Number of input elements known to be computed*/
-
     int cnt;                  /* # elements not NA/NaN, if Means and !keepNA */
     int i, j;                 /* Row and column indexes */
-    int k;                    /* Index going sequentially through whole matrix*/
+    int k;                    /* Index going sequentially through matrix */
 
-    if (p == 0) 
-        return;
-
-    HELPERS_SETUP_OUT (n>500 ? 4 : n>50 ? 5 : 6);
+    j = j0;
+    k = j0 * n;
 
     if (TYPEOF(x) == REALSXP) {
         double *rx = REAL(x);
         int e;
-        k = 0;
-        j = 0;
         if (keepNA) {
-            if (p & 1) {  /* sum first column if there are an odd number */
+            if ((j1-j0) & 1) {  /* sum first column if there are an odd number*/
                 long double sum;
                 e = k + n;
-                if (avail < e) HELPERS_WAIT_IN1 (avail, e-1, np);
                 sum = (n & 1) ? rx[k++] : 0.0;
                 while (k < e) {
                     sum += rx[k++];
                     sum += rx[k++];
                 }
                 a[j] = !Means ? sum : sum/n;
-                HELPERS_NEXT_OUT (j);
+                j += 1;
             }
-            while (j < p) {  /* sum pairs of columns */
+            while (j < j1) {  /* sum pairs of columns */
                 long double sum, sum2;
                 e = k + 2*n;
-                if (avail < e) HELPERS_WAIT_IN1 (avail, e-1, np);
                 if (n & 1) {
                     sum = rx[k];
                     sum2 = rx[k+n];
@@ -1664,30 +1666,25 @@ void task_colSums_or_colMeans (helpers_op_t op, SEXP ans, SEXP x, SEXP ignored)
                 }
                 k = e;
                 a[j] = !Means ? sum : sum/n;
-                HELPERS_NEXT_OUT (j);
-                a[j] = !Means ? sum2 : sum2/n;
-                HELPERS_NEXT_OUT (j);
+                a[j+1] = !Means ? sum2 : sum2/n;
+                j += 2;
             }
         }
         else { /* ! keepNA */
             if (!Means) {
                 long double sum;
-                while (j < p) {
-                    if (avail < k+n) HELPERS_WAIT_IN1 (avail, k+n-1, np);
+                for ( ; j < j1; j++) {
                     for (sum = 0.0, i = n; i > 0; i--, k++)
                         if (!ISNAN(rx[k])) sum += rx[k];
                     a[j] = sum;
-                    HELPERS_NEXT_OUT (j);
                 }
             }
             else {
                 long double sum;
-                while (j < p) {
-                    if (avail < k+n) HELPERS_WAIT_IN1 (avail, k+n-1, np);
+                for ( ; j < j1; j++) {
                     for (cnt = 0, sum = 0.0, i = n; i > 0; i--, k++)
                         if (!ISNAN(rx[k])) { cnt += 1; sum += rx[k]; }
                     a[j] = sum/cnt;
-                    HELPERS_NEXT_OUT (j);
                 }
             }
         }
@@ -1696,73 +1693,76 @@ void task_colSums_or_colMeans (helpers_op_t op, SEXP ans, SEXP x, SEXP ignored)
     else {
 
         int_fast64_t lsum; /* good to sum up to 2^32 integers or 2^63 logicals*/
-        int *ix;
+        int *ix = TYPEOF(x) == INTSXP ? INTEGER(x) : LOGICAL(x);
 
-        switch (TYPEOF(x)) {
-        case INTSXP:
-            ix = INTEGER(x);
-            k = 0;
-            j = 0;
-            while (j < p) {
-                if (avail < k+n) HELPERS_WAIT_IN1 (avail, k+n-1, np);
-                for (cnt = 0, lsum = 0, i = 0; i < n; i++, k++)
-                    if (ix[k] != NA_INTEGER) {
-                        cnt += 1; 
-                        lsum += ix[k];
-                    }
-                    else if (keepNA) {
-                        a[j] = NA_REAL;
-                        k += n-i;
-                        goto next_int;
-                    }
-                a[j] = !Means ? lsum : (double)lsum/cnt;
-              next_int:
-                HELPERS_NEXT_OUT (j);
-            }
-            break;
-        case LGLSXP:
-            ix = LOGICAL(x);
-            k = 0;
-            j = 0;
-            while (j < p) {
-                if (avail < k+n) HELPERS_WAIT_IN1 (avail, k+n-1, np);
-                for (cnt = 0, lsum = 0, i = 0; i < n; i++, k++)
-                    if (ix[k] != NA_LOGICAL) {
-                        cnt += 1; 
-                        lsum += ix[k];
-                    }
-                    else if (keepNA) {
-                        a[j] = NA_REAL; 
-                        k += n-i;
-                        goto next_logical;
-                    }
-                a[j] = !Means ? lsum : (double)lsum/cnt;
-              next_logical:
-                HELPERS_NEXT_OUT (j);
-            }
-            break;
+        /* NA_INTEGER and NA_LOGICAL are the same, so one loop does both. */
+
+        for ( ; j < j1; j++) {
+            for (cnt = 0, lsum = 0, i = 0; i < n; i++, k++)
+                if (ix[k] != NA_INTEGER) {
+                    cnt += 1; 
+                    lsum += ix[k];
+                }
+                else if (keepNA) {
+                    a[j] = NA_REAL;
+                    k += n-i;
+                    goto next;
+                }
+            a[j] = !Means ? lsum : (double)lsum/cnt;
+          next: ;
         }
     }
 }
 
-#define rowSums_together 1024 /* Sum this number of rows (or fewer) together */
-
-void task_rowSums_or_rowMeans (helpers_op_t op, SEXP ans, SEXP x, SEXP ignored)
+void task_colSums_or_colMeans (helpers_op_t op, SEXP ans, SEXP x, SEXP ignored)
 {
     int keepNA = op&1;        /* Don't skip NA/NaN elements? */
     int Means = op&2;         /* Find means rather than sums? */
-    unsigned p = op>>3;       /* Number of columns in matrix */
-    unsigned n = LENGTH(ans); /* Number of rows in matrix */
-    double *a = REAL(ans);    /* Pointer to result vector, initially the start*/
+    unsigned n = op>>3;       /* Number of rows in matrix */
+    unsigned p = LENGTH(ans); /* Number of columns in matrix */
+    double *a = REAL(ans);    /* Pointer to start of result vector */
+    int np = n*p;             /* Number of elements we need in total */
+    int avail = 0;            /* Number of input elements known to be computed*/
+
+    int j;                    /* Column index */
+    int k;                    /* Index of start of column j */
+    int u;                    /* Number of columns to do at once */
+
+    if (p == 0) 
+        return;
+
+    HELPERS_SETUP_OUT (n>500 ? 4 : n>50 ? 5 : 6);
+
+    /* Do all columns whose elements have been computed together. */
+
+    k = 0;
+    j = 0;
+    while (j < p) {
+        if (avail < k+n) HELPERS_WAIT_IN1 (avail, k+n-1, np);
+        u = n == 0 ? p-j : (avail-k) / n;
+        if (u > p-j) u = p-j;
+        col_sums (x, n, j, j+u, a, keepNA, Means);
+        k += u*n;
+        HELPERS_BLOCK_OUT (j, u);
+    }
+}
+
+#define rowSums_together 1024 /* Sum this number of rows (or fewer) together */
+
+/* Find sums or means of rows i0 to i1-1 of x, which has n rows and p
+   columns, storing them in a[i0] to a[i1-1]. */
 
+static void row_sums (SEXP x, int n, int p, int i0, int i1, double *a,
+                      int keepNA, int Means)
+{
     int i, j;                 /* Row and column indexes */
 
-    HELPERS_SETUP_OUT (p>20 ? 5 : 6);
+    a += i0;
 
     if (TYPEOF(x) == REALSXP) {
 
-        i = 0;
-        while (i < n) { /* sums up to rowSums_together rows each time around */
+        i = i0;
+        while (i < i1) { /* sums up to rowSums_together rows each time around */
 
             long double sums[rowSums_together];
             int cnts[rowSums_together];
@@ -1773,7 +1773,7 @@ void task_rowSums_or_rowMeans (helpers_op_t op, SEXP ans, SEXP x, SEXP ignored)
             int *c;
 
             rx = REAL(x) + i;
-            u = n - i;
+            u = i1 - i;
             if (u > rowSums_together) u = rowSums_together;
 
             if (keepNA) { /* uses unwrapped loop to sum two columns at once */
@@ -1846,7 +1846,7 @@ void task_rowSums_or_rowMeans (helpers_op_t op, SEXP ans, SEXP x, SEXP ignored)
                 }
             }
 
-            HELPERS_BLOCK_OUT (i, u);
+            i += u;
         }
     }
 
@@ -1857,58 +1857,280 @@ void task_rowSums_or_rowMeans (helpers_op_t op, SEXP ans, SEXP x, SEXP ignored)
         int *ix;
 
         /* This sums across rows, which doesn't have good cache behaviour.
-           Maybe should be improved to be like the REAL case someday... */
+           Maybe should be improved to be like the REAL case someday... 
+           NA_INTEGER and NA_LOGICAL are the same, so one loop does both. */
+
+        for (i = i0; i < i1; i++) {
+            ix = (TYPEOF(x) == INTSXP ? INTEGER(x) : LOGICAL(x)) + i;
+            for (cnt = 0, lsum = 0, j = 0; j < p; j++, ix += n)
+                if (*ix != NA_INTEGER) {
+                    cnt += 1; 
+                    lsum += *ix;
+                }
+                else if (keepNA) {
+                    *a++ = NA_REAL; 
+                    goto next;
+                }
+            *a++ = !Means ? lsum : (double)lsum/cnt;
+          next: ;
+        }
+    }
+}
 
-        switch (TYPEOF(x)) {
-        case INTSXP:
-            i = 0;
-            while (i < n) {
-                ix = INTEGER(x) + i;
-                for (cnt = 0, lsum = 0, j = 0; j < p; j++, ix += n)
-                    if (*ix != NA_INTEGER) {
-                        cnt += 1; 
-                        lsum += *ix;
-                    }
-                    else if (keepNA) {
-                        a[i] = NA_REAL; 
-                        goto next_int;
-                    }
-                a[i] = !Means ? lsum : (double)lsum/cnt;
-              next_int:
-                HELPERS_NEXT_OUT (i);
+void task_rowSums_or_rowMeans (helpers_op_t op, SEXP ans, SEXP x, SEXP ignored)
+{
+    int keepNA = op&1;        /* Don't skip NA/NaN elements? */
+    int Means = op&2;         /* Find means rather than sums? */
+    unsigned p = op>>3;       /* Number of columns in matrix */
+    unsigned n = LENGTH(ans); /* Number of rows in matrix */
+    double *a = REAL(ans);    /* Pointer to start of result vector */
+
+    int i, u;
+
+    HELPERS_SETUP_OUT (p>20 ? 5 : 6);
+
+    /* The REAL case sums rowSums_together rows at once, so output is in
+       blocks of that size.  Other types are done a row at a time. */
+
+    i = 0;
+    while (i < n) {
+        u = TYPEOF(x) != REALSXP ? 1 : n-i > rowSums_together ? rowSums_together
+                                                             : n-i;
+        row_sums (x, n, p, i, i+u, a, keepNA, Means);
+        HELPERS_BLOCK_OUT (i, u);
+    }
+}
+
+/* Accumulated state for finding a statistic other than a sum or mean for 
+   one row or column.  The na field is 1 if a NaN was seen and 2 if an NA
+   was seen (or, for var and sd, either when NAs aren't removed), and cnt 
+   is a count of values (var, sd), of NAs (count of NAs), or of values 
+   that decide the result (any, all).  The statistic is found in one pass
+   except for var and sd, where a second pass accumulates squared deviations
+   from the mean, m, found in the first pass. */
+
+struct stat_acc {
+    long double s;            /* Sum of values, then of squared deviations */
+    double m;                 /* Min or max, or mean for var and sd */
+    int cnt;
+    int na;
+};
+
+static R_INLINE void stat_init (int stat, struct stat_acc *a)
+{
+    a->s = 0;
+    a->m = stat == STAT_MIN ? R_PosInf : R_NegInf;
+    a->cnt = 0;
+    a->na = 0;
+}
+
+static R_INLINE void stat_add (int stat, int keepNA, struct stat_acc *a, 
+                               double v)
+{
+    if (ISNAN(v)) {
+        if (stat == STAT_NAS)
+            a->cnt += 1;
+        else if (keepNA && a->na < 2)
+            a->na = stat == STAT_VAR || stat == STAT_SD || R_IsNA(v) ? 2 : 1;
+        return;
+    }
+
+    switch (stat) {
+    case STAT_MIN: if (v < a->m) a->m = v; break;
+    case STAT_MAX: if (v > a->m) a->m = v; break;
+    case STAT_VAR: 
+    case STAT_SD:  a->s += v; a->cnt += 1; break;
+    case STAT_ANY: if (v != 0) a->cnt = 1; break;
+    case STAT_ALL: if (v == 0) a->cnt = 1; break;
+    }
+}
+
+/* Set up for the second pass for var and sd, returning TRUE if one is 
+   needed. */
+
+static R_INLINE int stat_mid (int stat, struct stat_acc *a)
+{
+    if ((stat != STAT_VAR && stat != STAT_SD) || a->na || a->cnt < 2)
+        return FALSE;
+    a->m = a->s / a->cnt;
+    a->s = 0;
+    return TRUE;
+}
+
+static R_INLINE void stat_add2 (struct stat_acc *a, double v)
+{
+    if (!ISNAN(v)) {
+        long double d = v - a->m;
+        a->s += d*d;
+    }
+}
+
+static R_INLINE void stat_store (int stat, struct stat_acc *a, SEXP ans, 
+                                 int j)
+{
+    switch (stat) {
+    case STAT_MIN: 
+    case STAT_MAX:
+        REAL(ans)[j] = a->na == 2 ? NA_REAL : a->na ? R_NaN : a->m;
+        break;
+    case STAT_VAR: 
+    case STAT_SD:
+        if (a->na || a->cnt < 2)
+            REAL(ans)[j] = NA_REAL;
+        else {
+            double v = a->s / (a->cnt - 1);
+            REAL(ans)[j] = stat == STAT_SD ? sqrt(v) : v;
+        }
+        break;
+    case STAT_ANY: 
+        LOGICAL(ans)[j] = a->cnt ? TRUE : a->na ? NA_LOGICAL : FALSE;
+        break;
+    case STAT_ALL: 
+        LOGICAL(ans)[j] = a->cnt ? FALSE : a->na ? NA_LOGICAL : TRUE;
+        break;
+    case STAT_NAS:
+        INTEGER(ans)[j] = a->cnt;
+        break;
+    }
+}
+
+#define stats_together 512  /* Rows (or part of a column) done together */
+
+/* Return a pointer to u elements of x as doubles, starting at index k, 
+   converting integer or logical elements into buf. */
+
+static R_INLINE const double *stat_block (SEXP x, R_xlen_t k, int u, 
+                                          double *buf)
+{
+    if (TYPEOF(x) == REALSXP)
+        return REAL(x) + k;
+
+    int *ix = (TYPEOF(x) == INTSXP ? INTEGER(x) : LOGICAL(x)) + k;
+    for (int i = 0; i < u; i++) 
+        buf[i] = ix[i] == NA_INTEGER ? NA_REAL : ix[i];
+    return buf;
+}
+
+/* Find a statistic for columns j0 to j1-1 of x, which has n rows, storing
+   them in ans[j0] to ans[j1-1]. */
+
+static void col_stats (int stat, int keepNA, SEXP x, int n, int j0, int j1,
+                       SEXP ans)
+{
+    double buf[stats_together];
+    const double *v;
+    struct stat_acc a;
+    int i, j, k, u;
+
+    if (stat == STAT_SUM || stat == STAT_MEAN) {
+        col_sums (x, n, j0, j1, REAL(ans), keepNA, stat == STAT_MEAN);
+        return;
+    }
+
+    for (j = j0; j < j1; j++) {
+        R_xlen_t c = (R_xlen_t) j * n;
+        stat_init (stat, &a);
+        for (i = 0; i < n; i += u) {
+            u = n-i > stats_together ? stats_together : n-i;
+            v = stat_block (x, c+i, u, buf);
+            for (k = 0; k < u; k++) stat_add (stat, keepNA, &a, v[k]);
+        }
+        if (stat_mid (stat, &a)) {
+            for (i = 0; i < n; i += u) {
+                u = n-i > stats_together ? stats_together : n-i;
+                v = stat_block (x, c+i, u, buf);
+                for (k = 0; k < u; k++) stat_add2 (&a, v[k]);
             }
-            break;
-        case LGLSXP:
-            i = 0;
-            while (i < n) {
-                ix = LOGICAL(x) + i;
-                for (cnt = 0, lsum = 0, j = 0; j < p; j++, ix += n)
-                    if (*ix != NA_LOGICAL) {
-                        cnt += 1; 
-                        lsum += *ix;
-                    }
-                    else if (keepNA) {
-                        a[i] = NA_REAL; 
-                        goto next_logical;
-                    }
-                a[i] = !Means ? lsum : (double)lsum/cnt;
-              next_logical:
-                HELPERS_NEXT_OUT (i);
+        }
+        stat_store (stat, &a, ans, j);
+    }
+}
+
+/* Find a statistic for rows i0 to i1-1 of x, which has n rows and p columns,
+   storing them in ans[i0] to ans[i1-1]. */
+
+static void row_stats (int stat, int keepNA, SEXP x, int n, int p, 
+                       int i0, int i1, SEXP ans)
+{
+    double buf[stats_together];
+    struct stat_acc a[stats_together];
+    const double *v;
+    int i, j, k, u, pass2;
+
+    if (stat == STAT_SUM || stat == STAT_MEAN) {
+        row_sums (x, n, p, i0, i1, REAL(ans), keepNA, stat == STAT_MEAN);
+        return;
+    }
+
+    for (i = i0; i < i1; i += u) {
+        u = i1-i > stats_together ? stats_together : i1-i;
+        for (k = 0; k < u; k++) stat_init (stat, &a[k]);
+        for (j = 0; j < p; j++) {
+            v = stat_block (x, i + (R_xlen_t) j * n, u, buf);
+            for (k = 0; k < u; k++) stat_add (stat, keepNA, &a[k], v[k]);
+        }
+        pass2 = FALSE;
+        for (k = 0; k < u; k++) 
+            if (stat_mid (stat, &a[k])) pass2 = TRUE;
+        if (pass2) {
+            for (j = 0; j < p; j++) {
+                v = stat_block (x, i + (R_xlen_t) j * n, u, buf);
+                for (k = 0; k < u; k++) stat_add2 (&a[k], v[k]);
             }
-            break;
         }
+        for (k = 0; k < u; k++) stat_store (stat, &a[k], ans, i+k);
     }
 }
 
-/* This implements (row/col)(Sums/Means). */
+/* Task procedure for finding a row or column statistic, possibly only for
+   part of the result.  The low bit of op is set if NAs are not removed, 
+   the next four bits are the statistic, and the next bit is set for row
+   statistics.  Bits 8 and up give the number of rows when doing columns, 
+   and the number of columns when doing rows.  The computation may be split
+   amongst s tasks, with op having w (from 0) in its top 8 bits and s-1 in 
+   the 8 bits below that, with each task doing a range of rows or columns.
+   Tasks other than the first wait for earlier tasks before finishing, so 
+   that the result is computed when the last one finishes (as for task_cov).*/
+
+#define MATRIX_STAT_OP(w,s,dim,rows,stat,keepNA) \
+  (((helpers_op_t)(w)<<56) | ((helpers_op_t)((s)-1)<<48) \
+     | ((helpers_op_t)(dim)<<8) | ((rows)<<5) | ((stat)<<1) | (keepNA))
+
+void task_matrix_stat (helpers_op_t op, SEXP ans, SEXP x, SEXP ignored)
+{
+    int keepNA = op & 1;
+    int stat = (op >> 1) & 0xf;
+    int rows = (op >> 5) & 1;
+    int dim = (op >> 8) & 0xffffffff;
+    int w = op >> 56;
+    int s = 1 + ((op >> 48) & 0xff);
+
+    int len = LENGTH(ans);
+    int r0 = (int) ((double) len * w / s);
+    int r1 = (int) ((double) len * (w+1) / s);
+
+    if (rows)
+        row_stats (stat, keepNA, x, len, dim, r0, r1, ans);
+    else
+        col_stats (stat, keepNA, x, dim, r0, r1, ans);
+
+    if (w != 0) {
+        while (helpers_avail0(len) < len) ;
+    }
+}
+
+/* This implements (row/col)(Sums/Means/Mins/...).  Sums and means that 
+   aren't split amongst helpers are done with tasks that can pipeline 
+   their output (and input, for columns). */
 
 #define T_colSums THRESHOLD_ADJUST(300)
 #define T_rowSums THRESHOLD_ADJUST(300)
+#define T_matrix_stat_split THRESHOLD_ADJUST(10000) /* Min elements per task */
 
 static SEXP do_colsum (SEXP call, SEXP op, SEXP args, SEXP rho, int variant)
 {
     SEXP x, ans;
-    int OP, n, p;
+    int OP, n, p, stat, rows, len, dim, s, w;
     int NaRm;
 
     checkArity(op, args);
@@ -1939,19 +2161,49 @@ static SEXP do_colsum (SEXP call, SEXP op, SEXP args, SEXP rho, int variant)
 	error(_("invalid '%s' argument"), "n*p");
 
     OP = PRIMVAL(op);
+    stat = OP & 0xf;
+    rows = OP >> 4;
+    len = rows ? n : p;
+    dim = rows ? p : n;
+
+    ans = allocVector (stat == STAT_ANY || stat == STAT_ALL ? LGLSXP 
+                        : stat == STAT_NAS ? INTSXP : REALSXP, len);
+
+    /* See how many tasks to split the computation amongst. */
+
+    s = helpers_not_multithreading_now ? 1 : helpers_num + 1;
+    if (s > len) s = len;
+    while (s > 1 && (double) s * T_matrix_stat_split > (double) n * p) s -= 1;
+
+    if (stat <= STAT_MEAN && (s <= 1 || helpers_is_being_computed(x))) {
+        if (!rows)
+            DO_NOW_OR_LATER1 (variant, LENGTH(x) >= T_colSums,
+              HELPERS_PIPE_IN1_OUT, task_colSums_or_colMeans, 
+              ((helpers_op_t)n<<3) | (stat<<1) | !NaRm, ans, x);
+        else
+            DO_NOW_OR_LATER1 (variant, LENGTH(x) >= T_rowSums,
+              HELPERS_PIPE_OUT, task_rowSums_or_rowMeans, 
+              ((helpers_op_t)p<<3) | (stat<<1) | !NaRm, ans, x);
+    }
 
-    if (OP < 2) { /* columns */
-        ans = allocVector (REALSXP, p);
+    else if (s <= 1) {
         DO_NOW_OR_LATER1 (variant, LENGTH(x) >= T_colSums,
-          HELPERS_PIPE_IN1_OUT, task_colSums_or_colMeans, 
-          ((helpers_op_t)n<<3) | (OP<<1) | !NaRm, ans, x);
+          0, task_matrix_stat, 
+          MATRIX_STAT_OP (0, 1, dim, rows, stat, !NaRm), ans, x);
     }
 
-    else { /* rows */
-        ans = allocVector (REALSXP, n);
-        DO_NOW_OR_LATER1 (variant, LENGTH(x) >= T_rowSums,
-          HELPERS_PIPE_OUT, task_rowSums_or_rowMeans, 
-          ((helpers_op_t)p<<3) | (OP<<1) | !NaRm, ans, x);
+    else {
+        PROTECT(ans);
+        for (w = 0; w < s; w++)
+            helpers_do_task (w == 0   ? HELPERS_PIPE_OUT :
+                             w < s-1  ? HELPERS_PIPE_IN0_OUT 
+                                      : HELPERS_PIPE_IN0,
+                             task_matrix_stat,
+                             MATRIX_STAT_OP (w, s, dim, rows, stat, !NaRm),
+                             ans, x, (helpers_var_ptr)0);
+        if (! (variant & VARIANT_PENDING_OK))
+            WAIT_UNTIL_COMPUTED(ans);
+        UNPROTECT(1);
     }
 
     return ans;
@@ -2207,8 +2459,22 @@ attribute_hidden FUNTAB R_FunTab_array[] =
 {"aperm",	do_aperm,	0,    1000011,	3,	{PP_FUNCALL, PREC_FN,	0}},
 {"colSums",	do_colsum,	0,    1011011,	4,	{PP_FUNCALL, PREC_FN,	0}},
 {"colMeans",	do_colsum,	1,    1011011,	4,	{PP_FUNCALL, PREC_FN,	0}},
-{"rowSums",	do_colsum,	2,    1011011,	4,	{PP_FUNCALL, PREC_FN,	0}},
-{"rowMeans",	do_colsum,	3,    1011011,	4,	{PP_FUNCALL, PREC_FN,	0}},
+{"rowSums",	do_colsum,	16,   1011011,	4,	{PP_FUNCALL, PREC_FN,	0}},
+{"rowMeans",	do_colsum,	17,   1011011,	4,	{PP_FUNCALL, PREC_FN,	0}},
+{"colMins",	do_colsum,	2,    1011011,	4,	{PP_FUNCALL, PREC_FN,	0}},
+{"colMaxs",	do_colsum,	3,    1011011,	4,	{PP_FUNCALL, PREC_FN,	0}},
+{"colVars",	do_colsum,	4,    1011011,	4,	{PP_FUNCALL, PREC_FN,	0}},
+{"colSds",	do_colsum,	5,    1011011,	4,	{PP_FUNCALL, PREC_FN,	0}},
+{"colAnys",	do_colsum,	6,    1011011,	4,	{PP_FUNCALL, PREC_FN,	0}},
+{"colAlls",	do_colsum,	7,    1011011,	4,	{PP_FUNCALL, PREC_FN,	0}},
+{"colCountNAs",	do_colsum,	8,    1011011,	4,	{PP_FUNCALL, PREC_FN,	0}},
+{"rowMins",	do_colsum,	18,   1011011,	4,	{PP_FUNCALL, PREC_FN,	0}},
+{"rowMaxs",	do_colsum,	19,   1011011,	4,	{PP_FUNCALL, PREC_FN,	0}},
+{"rowVars",	do_colsum,	20,   1011011,	4,	{PP_FUNCALL, PREC_FN,	0}},
+{"rowSds",	do_colsum,	21,   1011011,	4,	{PP_FUNCALL, PREC_FN,	0}},
+{"rowAnys",	do_colsum,	22,   1011011,	4,	{PP_FUNCALL, PREC_FN,	0}},
+{"rowAlls",	do_colsum,	23,   1011011,	4,	{PP_FUNCALL, PREC_FN,	0}},
+{"rowCountNAs",	do_colsum,	24,   1011011,	4,	{PP_FUNCALL, PREC_FN,	0}},
 {"diag",        do_diag,        0,      11,     3,      {PP_FUNCALL, PREC_FN,	0}},
 {"lengths",     do_lengths,     0,      11,     2,      {PP_FUNCALL, PREC_FN,   0}},
 
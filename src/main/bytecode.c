@@ -110,6 +110,15 @@ static void loadCompilerNamespace(void)
     UNPROTECT(3);
 }
 
+/* JIT compilation is never done in pqR, and no native-code tier is provided
+   for byte-compiled loops.  Byte code is used only when R_USE_BYTECODE is
+   set to TRUE, and lacks many pqR optimizations (eg, the scalar stack, task
+   merging, and deferred evaluation using helper threads), so a native-code
+   generator keyed to byte code hot spots (eg, via backedge counters at GOTO
+   and STEPFOR) would benefit only code that is already slower than when
+   interpreted.  Speedups for scalar loops are instead pursued in the
+   interpreter (see do_for in eval.c and the scalar stack in scalar-stack.h). */
+
 void attribute_hidden R_init_jit_enabled(void)
 {
     if (R_jit_enabled <= 0) {
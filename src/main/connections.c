@@ -118,6 +118,10 @@ static void con_destroy(int i);
 # undef truncate
 #endif
 
+#ifdef HAVE_SYS_STAT_H
+# include <sys/stat.h>
+#endif
+
 /* This works on Win64 where long is 4 bytes but long long is 8 bytes. */
 #if defined __GNUC__ && __GNUC__ >= 2
 __extension__ typedef long long int _lli_t;
@@ -396,6 +400,17 @@ int dummy_vfprintf(Rconnection con, const char *format, va_list ap)
     return res;
 }
 
+/* Size of the buffer used in place of iconvbuff when input isn't
+   converted, for connections that can't block waiting for it to fill. */
+
+#define RBUFF_SIZE (1 << 16)
+
+static void set_rbuff (Rconnection con)
+{
+    if (con->canread && con->text && !con->inconv && con->rbuff == NULL)
+        con->rbuff = malloc (RBUFF_SIZE);  /* iconvbuff used if NULL */
+}
+
 /* Don't let it be inlined below, so that dummy_fgetc will be small,
    without big function preamble. */
 
@@ -404,6 +419,15 @@ static attribute_noinline void buff_iconv (Rconnection con)
     if (con->EOF_signalled)
         return;
 
+    if (con->rbuff != NULL && !con->inconv) {
+        size_t new = con->read (con->rbuff, sizeof(char), RBUFF_SIZE, con);
+        if (new == 0)
+            con->EOF_signalled = TRUE;
+        con->next = con->rbuff;
+        con->navail = new;
+        return;
+    }
+
     Rboolean checkBOM = FALSE;
     
     if (con->inavail == -2) {
@@ -558,6 +582,379 @@ void init_con(Rconnection new, const char *description, int enc,
     new->id = current_id;
     new->ex_ptr = R_NoObject;
     new->n_saved = 0;
+    new->prefetch = NULL;
+    new->rbuff = NULL;
+}
+
+/* ------------------- reading ahead in another thread ------------------- */
+
+/* A file or compressed file connection created with prefetch = TRUE,
+   when opened only for reading, has a thread that reads ahead into one
+   of two buffers while the master thread takes data from the other, so
+   that reading (and for compressed files, decompressing) overlaps with
+   computation.  The read, fgetc_internal, and seek methods are replaced
+   by ones using the buffers, and the original read method is called only
+   in the prefetch thread, which is started when data is first wanted,
+   and stopped before seeking or closing.  Warnings from the read method
+   in the prefetch thread are saved, and issued when the master reaches
+   the data read when they occurred. */
+
+#ifndef Win32
+
+#include <pthread.h>
+
+#define PREFETCH_SIZE (1 << 18)  /* Size of each of the two buffers */
+#define PREFETCH_MSG_LEN 256     /* Space for a saved warning message */
+
+typedef struct prefetch {
+    /* Original methods of the connection */
+    Rboolean (*open)(Rconnection);
+    void (*close)(Rconnection);
+    void (*destroy)(Rconnection);
+    int (*fgetc_internal)(Rconnection);
+    double (*seek)(Rconnection, double, int, int);
+    size_t (*read)(void *, size_t, size_t, Rconnection);
+
+    int active;                 /* Open with the methods below in use? */
+    char *buf[2];               /* The two buffers */
+
+    /* Fields shared with the prefetch thread, protected by mutex */
+    pthread_mutex_t mutex;
+    pthread_cond_t cond;        /* Signalled when full or stop changes */
+    int full[2];                /* Buffer filled, and not yet used up? */
+    size_t len[2];              /* Number of bytes in a full buffer */
+    int eof[2];                 /* Nothing more after this buffer? */
+    int stop;                   /* Asks the thread to stop */
+    int finished;               /* Has filled a buffer with eof set? */
+
+    /* Fields for the prefetch thread only, while it is running */
+    int next;                   /* Buffer to fill next */
+    int reading;                /* Inside the original read method? */
+    char msg[2][PREFETCH_MSG_LEN];  /* Warning (or "") for each buffer */
+
+    /* Fields for the master only */
+    pthread_t thread;
+    int started;                /* Thread created and not yet joined? */
+    int cur;                    /* Buffer being used by the master */
+    int acquired;               /* Has the master waited for buf[cur]? */
+    size_t pos, avail;          /* Position in, and length of, buf[cur] */
+    int at_eof;                 /* All data has been used up? */
+} *Rprefetch;
+
+static void *prefetch_thread(void *arg)
+{
+    Rconnection con = arg;
+    Rprefetch pf = con->prefetch;
+    int i, eof, stop;
+    size_t n;
+
+    do {
+        i = pf->next;
+        pthread_mutex_lock(&pf->mutex);
+        while (pf->full[i] && !pf->stop)
+            pthread_cond_wait(&pf->cond, &pf->mutex);
+        stop = pf->stop;
+        pthread_mutex_unlock(&pf->mutex);
+        if (stop)
+            break;
+
+        pf->msg[i][0] = 0;
+        pf->reading = 1;
+        n = pf->read(pf->buf[i], 1, PREFETCH_SIZE, con);
+        pf->reading = 0;
+        eof = n < PREFETCH_SIZE;
+
+        pthread_mutex_lock(&pf->mutex);
+        pf->len[i] = n;
+        pf->eof[i] = eof;
+        pf->full[i] = 1;
+        if (eof)
+            pf->finished = 1;
+        pthread_cond_broadcast(&pf->cond);
+        pthread_mutex_unlock(&pf->mutex);
+        pf->next = 1-i;
+    } while (!eof);
+
+    return NULL;
+}
+
+/* Stop the prefetch thread, if it is running.  Buffers it has filled
+   stay valid. */
+
+static void prefetch_stop(Rprefetch pf)
+{
+    if (!pf->started)
+        return;
+
+    pthread_mutex_lock(&pf->mutex);
+    pf->stop = 1;
+    pthread_cond_broadcast(&pf->cond);
+    pthread_mutex_unlock(&pf->mutex);
+    pthread_join(pf->thread, NULL);
+
+    pf->stop = 0;
+    pf->started = 0;
+}
+
+/* Discard all data read ahead, as after a seek, or when first opened. */
+
+static void prefetch_reset(Rprefetch pf)
+{
+    pf->full[0] = pf->full[1] = 0;
+    pf->eof[0] = pf->eof[1] = 0;
+    pf->msg[0][0] = pf->msg[1][0] = 0;
+    pf->next = pf->cur = 0;
+    pf->acquired = pf->finished = pf->at_eof = 0;
+    pf->pos = pf->avail = 0;
+}
+
+/* Number of bytes read by the original method but not yet used. */
+
+static size_t prefetch_unused(Rprefetch pf)
+{
+    size_t n = pf->acquired ? pf->avail - pf->pos : 0;
+    int i;
+
+    for (i = 0; i < 2; i++)
+        if (pf->full[i] && !(pf->acquired && i == pf->cur))
+            n += pf->len[i];
+    return n;
+}
+
+/* Make buf[cur] available to the master, starting the thread if needed
+   and waiting for the thread to fill it.  Returns FALSE at end of file. */
+
+static Rboolean prefetch_acquire(Rconnection con)
+{
+    Rprefetch pf = con->prefetch;
+    int i = pf->cur;
+    int start;
+
+    if (pf->at_eof)
+        return FALSE;
+
+    pthread_mutex_lock(&pf->mutex);
+    start = !pf->full[i] && !pf->finished;
+    pthread_mutex_unlock(&pf->mutex);
+
+    if (start && !pf->started) {
+        if (pthread_create(&pf->thread, NULL, prefetch_thread, con) != 0)
+            error(_("cannot create thread for reading ahead"));
+        pf->started = 1;
+    }
+
+    pthread_mutex_lock(&pf->mutex);
+    while (!pf->full[i])
+        pthread_cond_wait(&pf->cond, &pf->mutex);
+    pthread_mutex_unlock(&pf->mutex);
+
+    pf->acquired = 1;
+    pf->pos = 0;
+    pf->avail = pf->len[i];
+
+    if (pf->msg[i][0] != 0) {
+        char msg[PREFETCH_MSG_LEN];
+        strcpy(msg, pf->msg[i]);
+        pf->msg[i][0] = 0;
+        warning("%s", msg);
+    }
+
+    return pf->avail > 0 || !pf->eof[i];
+}
+
+/* Give buf[cur], now used up, back to the thread to fill again. */
+
+static void prefetch_release(Rprefetch pf)
+{
+    int i = pf->cur;
+
+    if (pf->eof[i])
+        pf->at_eof = 1;
+
+    pthread_mutex_lock(&pf->mutex);
+    pf->full[i] = 0;
+    pthread_cond_broadcast(&pf->cond);
+    pthread_mutex_unlock(&pf->mutex);
+
+    pf->acquired = 0;
+    pf->pos = pf->avail = 0;
+    pf->cur = 1-i;
+}
+
+static size_t prefetch_read(void *ptr, size_t size, size_t nitems,
+                            Rconnection con)
+{
+    Rprefetch pf = con->prefetch;
+    size_t want = size * nitems, got = 0, n;
+
+    while (got < want) {
+        if (!pf->acquired && !prefetch_acquire(con)) {
+            if (pf->acquired) prefetch_release(pf);
+            break;
+        }
+        n = pf->avail - pf->pos;
+        if (n > want - got) n = want - got;
+        memcpy((char *) ptr + got, pf->buf[pf->cur] + pf->pos, n);
+        pf->pos += n;
+        got += n;
+        if (pf->pos == pf->avail)
+            prefetch_release(pf);
+    }
+
+    return got / size;
+}
+
+static int prefetch_fgetc_internal(Rconnection con)
+{
+    Rprefetch pf = con->prefetch;
+    unsigned char c;
+
+    if (pf->pos < pf->avail) {
+        c = pf->buf[pf->cur][pf->pos++];
+        if (pf->pos == pf->avail)
+            prefetch_release(pf);
+        return c;
+    }
+
+    return prefetch_read(&c, 1, 1, con) == 1 ? c : R_EOF;
+}
+
+static double prefetch_seek(Rconnection con, double where, int origin, 
+                            int rw)
+{
+    Rprefetch pf = con->prefetch;
+    double pos;
+
+    prefetch_stop(pf);
+    pos = pf->seek(con, NA_REAL, origin, rw) - prefetch_unused(pf);
+
+    if (!ISNA(where)) {
+        if (origin == 2) { /* relative to the position as seen by user */
+            where += pos;
+            origin = 1;
+        }
+        prefetch_reset(pf);
+        pf->seek(con, where, origin, rw);
+    }
+
+    return pos;
+}
+
+static Rboolean prefetch_open(Rconnection con)
+{
+    Rprefetch pf = con->prefetch;
+
+    if (!pf->open(con))
+        return FALSE;
+
+    if (con->canread && !con->canwrite
+         && (con->blocking || strcmp(con->class, "file") != 0)) {
+        pf->buf[0] = malloc(PREFETCH_SIZE);
+        pf->buf[1] = malloc(PREFETCH_SIZE);
+        if (pf->buf[0] == NULL || pf->buf[1] == NULL) {
+            free(pf->buf[0]);
+            free(pf->buf[1]);
+            return TRUE;  /* just read without prefetching */
+        }
+        prefetch_reset(pf);
+        pf->fgetc_internal = con->fgetc_internal;
+        pf->seek = con->seek;
+        pf->read = con->read;
+        con->fgetc_internal = &prefetch_fgetc_internal;
+        con->seek = &prefetch_seek;
+        con->read = &prefetch_read;
+        pf->active = 1;
+    }
+
+    return TRUE;
+}
+
+static void prefetch_close(Rconnection con)
+{
+    Rprefetch pf = con->prefetch;
+
+    if (pf->active) {
+        prefetch_stop(pf);
+        con->fgetc_internal = pf->fgetc_internal;
+        con->seek = pf->seek;
+        con->read = pf->read;
+        free(pf->buf[0]);
+        free(pf->buf[1]);
+        pf->active = 0;
+    }
+
+    pf->close(con);
+}
+
+static void prefetch_destroy(Rconnection con)
+{
+    Rprefetch pf = con->prefetch;
+
+    pf->destroy(con);
+    pthread_mutex_destroy(&pf->mutex);
+    pthread_cond_destroy(&pf->cond);
+    free(pf);
+    con->prefetch = NULL;
+}
+
+/* Arrange for a connection (not yet open) to read ahead when opened
+   only for reading. */
+
+static void set_prefetch(Rconnection con)
+{
+    Rprefetch pf = calloc(1, sizeof *pf);
+    if (pf == NULL)
+        return;  /* just read without prefetching */
+
+    pthread_mutex_init(&pf->mutex, NULL);
+    pthread_cond_init(&pf->cond, NULL);
+    pf->open = con->open;
+    pf->close = con->close;
+    pf->destroy = con->destroy;
+    con->open = &prefetch_open;
+    con->close = &prefetch_close;
+    con->destroy = &prefetch_destroy;
+    con->prefetch = pf;
+}
+
+/* Is this call of a read method in a prefetch thread?  Decided from
+   "reading", which only the thread sets, since the thread may start
+   reading (and warn) before the master has set "started".  The master
+   never calls the original read method while the thread is running. */
+
+static int in_prefetch_thread(Rconnection con)
+{
+    Rprefetch pf = con->prefetch;
+    return pf != NULL && pf->active && pf->reading;
+}
+
+#else
+
+static void set_prefetch(Rconnection con) { }
+
+static int in_prefetch_thread(Rconnection con) { return 0; }
+
+#endif
+
+/* Issue a warning from a read method, or save it if in a prefetch thread. */
+
+static void con_warning(Rconnection con, const char *format, ...)
+{
+    char buf[256];
+    va_list ap;
+
+    va_start(ap, format);
+    if (in_prefetch_thread(con)) {
+#ifndef Win32
+        Rprefetch pf = con->prefetch;
+        vsnprintf(pf->msg[pf->next], PREFETCH_MSG_LEN, format, ap);
+#endif
+        va_end(ap);
+        return;
+    }
+    vsnprintf(buf, sizeof buf, format, ap);
+    va_end(ap);
+    warning("%s", buf);
 }
 
 /* ------------------- file connections --------------------- */
@@ -727,6 +1124,13 @@ static Rboolean file_open(Rconnection con)
     else con->text = TRUE;
     con->save = -1000;
     set_iconv(con);
+#ifdef HAVE_SYS_STAT_H
+    {   /* not for pipes, terminals, etc., where reads may block */
+	struct stat sb;
+	if(fstat(fileno(fp), &sb) == 0 && S_ISREG(sb.st_mode))
+	    set_rbuff(con);
+    }
+#endif
 
 #ifdef HAVE_FCNTL
     if(!con->blocking) {
@@ -735,6 +1139,12 @@ static Rboolean file_open(Rconnection con)
 	flags |= O_NONBLOCK;
 	fcntl(fd, F_SETFL, flags);
     }
+#endif
+#if defined(HAVE_FCNTL_H) && defined(POSIX_FADV_SEQUENTIAL)
+    /* Files opened only for reading are usually read from start to end,
+       so ask for more read-ahead. */
+    if(con->canread && !con->canwrite)
+	posix_fadvise(fileno(fp), 0, 0, POSIX_FADV_SEQUENTIAL);
 #endif
     return TRUE;
 }
@@ -1352,6 +1762,7 @@ static Rboolean gzfile_open(Rconnection con)
     con->canread = !con->canwrite;
     con->text = strchr(con->mode, 'b') ? FALSE : TRUE;
     set_iconv(con);
+    set_rbuff(con);
     con->save = -1000;
     return TRUE;
 }
@@ -1460,6 +1871,7 @@ typedef struct bzfileconn {
     FILE *fp;
     BZFILE *bfp;
     int compress;
+    char name[PATH_MAX+1];  /* Expanded file name, for warnings from read */
 } *Rbzfileconn;
 
 static Rboolean bzfile_open(Rconnection con)
@@ -1503,9 +1915,12 @@ static Rboolean bzfile_open(Rconnection con)
     }
     bz->fp = fp;
     bz->bfp = bfp;
+    strncpy(bz->name, R_ExpandFileName(con->description), PATH_MAX);
+    bz->name[PATH_MAX] = '\0';
     con->isopen = TRUE;
     con->text = strchr(con->mode, 'b') ? FALSE : TRUE;
     set_iconv(con);
+    set_rbuff(con);
     con->save = -1000;
     return TRUE;
 }
@@ -1550,16 +1965,20 @@ static size_t bzfile_read(void *ptr, size_t size, size_t nitems,
 		    /* given that this should be rare I don't want to add that overhead
 		       to the entire bz structure so we allocate memory temporarily */
 		    next_unused = (char*) malloc(nUnused);
-		    if (!next_unused)
-			error(_("allocation of overflow buffer for bzfile failed"));
+		    if (!next_unused) {
+			if (!in_prefetch_thread(con))
+			    error(_("allocation of overflow buffer for bzfile failed"));
+			con_warning(con, _("allocation of overflow buffer for bzfile failed"));
+			return nread / size;
+		    }
 		    memcpy(next_unused, unused, nUnused);
 		}
 		if (nUnused > 0 || !feof(bz->fp)) {
 		    BZ2_bzReadClose(&bzerror, bz->bfp);	
 		    bz->bfp = BZ2_bzReadOpen(&bzerror, bz->fp, 0, 0, next_unused, nUnused);
 		    if(bzerror != BZ_OK)
-			warning(_("file '%s' has trailing content that appears not to be compressed by bzip2"),
-				R_ExpandFileName(con->description));
+			con_warning(con, _("file '%s' has trailing content that appears not to be compressed by bzip2"),
+				    bz->name);
 		}
 		if (next_unused) free(next_unused);
 	    }
@@ -1700,6 +2119,7 @@ static Rboolean xzfile_open(Rconnection con)
     con->isopen = TRUE;
     con->text = strchr(con->mode, 'b') ? FALSE : TRUE;
     set_iconv(con);
+    set_rbuff(con);
     con->save = -1000;
     return TRUE;
 }
@@ -1753,16 +2173,16 @@ static size_t xzfile_read(void *ptr, size_t size, size_t nitems,
 		switch(ret) {
 		case LZMA_MEM_ERROR:
 		case LZMA_MEMLIMIT_ERROR:
-		    warning("lzma decoder needed more memory");
+		    con_warning(con, "lzma decoder needed more memory");
 		    break;
 		case LZMA_FORMAT_ERROR:
-		    warning("lzma decoder format error");
+		    con_warning(con, "lzma decoder format error");
 		    break;
 		case LZMA_DATA_ERROR:
-		    warning("lzma decoder corrupt data");
+		    con_warning(con, "lzma decoder corrupt data");
 		    break;
 		default:
-		    warning("lzma decoding result %d", ret);
+		    con_warning(con, "lzma decoding result %d", ret);
 		}
 	    }
 	    return given/size;
@@ -1861,7 +2281,7 @@ static SEXP do_gzfile(SEXP call, SEXP op, SEXP args, SEXP env)
 {
     SEXP sfile, sopen, ans, class, enc;
     const char *file, *open;
-    int ncon, compress = 9;
+    int ncon, compress = 9, prefetch;
     Rconnection con;
     int type = PRIMVAL(op);
     int subtype = 0;
@@ -1890,6 +2310,9 @@ static SEXP do_gzfile(SEXP call, SEXP op, SEXP args, SEXP env)
 	if(compress == NA_LOGICAL || abs(compress) > 9)
 	    error(_("invalid '%s' argument"), "compress");
     }
+    prefetch = asLogical(CAD4R(args));
+    if(prefetch == NA_LOGICAL)
+	error(_("invalid '%s' argument"), "prefetch");
     open = CHAR(STRING_ELT(sopen, 0)); /* ASCII */
     if (type == 0 && (!open[0] || open[0] == 'r')) {
 	/* check magic no */
@@ -1927,6 +2350,7 @@ static SEXP do_gzfile(SEXP call, SEXP op, SEXP args, SEXP env)
     }
     ncon = NextConnection();
     Connections[ncon] = con;
+    if(prefetch) set_prefetch(con);
     strncpy(con->encname, CHAR(STRING_ELT(enc, 0)), 100); /* ASCII */
     con->encname[100 - 1] = '\0';
 
@@ -3212,6 +3636,7 @@ static void con_close1(Rconnection con)
     /* close inconv and outconv if open */
     if(con->inconv) Riconv_close(con->inconv);
     if(con->outconv) Riconv_close(con->outconv);
+    free(con->rbuff);
     con->destroy(con);
     free(con->class);
     free(con->description);
@@ -3477,20 +3902,60 @@ static SEXP do_readLines(SEXP call, SEXP op, SEXP args, SEXP env)
     PROTECT(ans = allocVector (STRSXP, nn));
     PROTECT(buf = allocVector (RAWSXP, buf_size));
 
-    int nread, nbuf, c;
+    int nread, nbuf, c, k;
 
     for (nread = 0; nread < nnn; nread++) {
 
         nbuf = 0;
-        while ((c = Rconn_fgetc(con)) != R_EOF && c != '\n') {
-            if (nbuf == buf_size-1) {  /* need space for the null */
-                if (buf_size == INT_MAX)
+        for (;;) {
+
+            /* When characters would just be taken one at a time from the
+               buffer filled by buff_iconv, copy all up to the next newline
+               or carriage return at once.  Otherwise, or when the buffer
+               is empty, get a character with Rconn_fgetc, which also maps
+               CR and CRLF to LF. */
+
+            const char *p = NULL, *e = NULL;
+            if (con->fgetc == dummy_fgetc && con->navail > 0
+                  && con->save == -1000 && con->save2 == -1000
+                  && con->nPushBack == 0) {
+                p = con->next;
+                e = memchr (p, '\n', con->navail);
+                k = e ? e - p : con->navail;
+                e = memchr (p, '\r', k);
+                if (e != NULL) 
+                    k = e - p;
+                else if (k < con->navail)
+                    e = p + k;
+            }
+            else
+                k = 1;
+
+            if (k > buf_size-1 - nbuf) {  /* need space for the null */
+                if (k > INT_MAX-1 - nbuf)
                     error(_("R character strings are limited to 2^31-1 bytes"));
-                buf_size = buf_size > INT_MAX/2 ? INT_MAX : 2*buf_size;
+                while (k > buf_size-1 - nbuf)
+                    buf_size = buf_size > INT_MAX/2 ? INT_MAX : 2*buf_size;
                 buf = reallocVector (buf, buf_size, 1);
                 UNPROTECT(2); PROTECT2(ans,buf);
             }
-            RAW(buf)[nbuf++] = c;
+
+            if (p == NULL) {
+                c = Rconn_fgetc(con);
+                if (c == R_EOF || c == '\n')
+                    break;
+                RAW(buf)[nbuf++] = c;
+            }
+            else {
+                memcpy (RAW(buf)+nbuf, p, k);
+                nbuf += k;
+                con->next += k;
+                con->navail -= k;
+                if (e != NULL) {
+                    c = Rconn_fgetc(con);  /* gets the newline */
+                    break;
+                }
+            }
         }
         RAW(buf)[nbuf] = '\0';
 
@@ -3502,7 +3967,10 @@ static SEXP do_readLines(SEXP call, SEXP op, SEXP args, SEXP env)
             UNPROTECT(2); PROTECT2(ans,buf);
         }
 
-        SET_STRING_ELT (ans, nread, mkCharCE (RAW(buf), oenc));
+        /* The line ends at an embedded null, if there is one. */
+        const char *z = memchr (RAW(buf), 0, nbuf);
+        SET_STRING_ELT (ans, nread, mkCharLenCE ((char *) RAW(buf), 
+                                      z ? z - (char *) RAW(buf) : nbuf, oenc));
 
         if (c == R_EOF) goto no_more_lines;
     }
@@ -3537,6 +4005,29 @@ no_more_lines:
     return ans;
 }
 
+/* Put len characters at s into the buffer for writeLines, writing out
+   what's in the buffer first if they don't fit, and writing them directly
+   if they wouldn't fit even in an empty buffer. */
+
+#define WRITELINES_BUFSIZE (1 << 16)
+
+static void writelines_put (Rconnection con, char *buf, size_t *nbuf,
+                            const char *s, size_t len)
+{
+    if (*nbuf + len > WRITELINES_BUFSIZE) {
+        if (*nbuf > 0) {
+            con->write (buf, sizeof(char), *nbuf, con);
+            *nbuf = 0;
+        }
+        if (len > WRITELINES_BUFSIZE) {
+            con->write (s, sizeof(char), len, con);
+            return;
+        }
+    }
+    memcpy (buf + *nbuf, s, len);
+    *nbuf += len;
+}
+
 /* writeLines(text, con = stdout(), sep = "\n", useBytes) */
 static SEXP do_writelines(SEXP call, SEXP op, SEXP args, SEXP env)
 {
@@ -3598,6 +4089,22 @@ static SEXP do_writelines(SEXP call, SEXP op, SEXP args, SEXP env)
             con0->fflush(con0);
             con_num = getActiveSink(j++);
         } while (con_num > 0);
+    } else if (!con->outconv && (con->vfprintf == &file_vfprintf
+                                  || con->vfprintf == &dummy_vfprintf)) {
+        /* Output would just go to con->write, so gather it into large
+           blocks, rather than calling Rconn_printf for each piece. */
+        SEXP b = PROTECT (allocVector (RAWSXP, WRITELINES_BUFSIZE));
+        size_t seplen = strlen(ssep), nbuf = 0;
+        for(i = 0; i < LENGTH(text); i++) {
+            const char *s = useBytes ? CHAR(STRING_ELT(text, i))
+                                     : translateChar0(STRING_ELT(text, i));
+            writelines_put (con, (char *) RAW(b), &nbuf, s, strlen(s));
+            if (seplen > 0) 
+                writelines_put (con, (char *) RAW(b), &nbuf, ssep, seplen);
+        }
+        if (nbuf > 0)
+            con->write (RAW(b), sizeof(char), nbuf, con);
+        UNPROTECT(1);
     } else {
         for(i = 0; i < LENGTH(text); i++) {
             Rconn_printf (con, "%s",
@@ -3626,6 +4133,83 @@ static void swapb(void *result, int size)
     }
 }
 
+/* Reverse the bytes in each of n items of the given size, with simple
+   loops for the common sizes, which the compiler may vectorize. */
+
+static void swap_items(void *p, int size, int n)
+{
+    char *q = p;
+    int i;
+
+    switch (size) {
+    case 1:
+	break;
+    case 2:
+	for (i = 0; i < n; i++, q += 2) {
+	    uint16_t u;
+	    memcpy(&u, q, 2);
+	    u = (u >> 8) | (u << 8);
+	    memcpy(q, &u, 2);
+	}
+	break;
+    case 4:
+	for (i = 0; i < n; i++, q += 4) {
+	    uint32_t u;
+	    memcpy(&u, q, 4);
+	    u = (u >> 24) | ((u >> 8) & 0xff00) | ((u << 8) & 0xff0000)
+	          | (u << 24);
+	    memcpy(q, &u, 4);
+	}
+	break;
+    case 8:
+	for (i = 0; i < n; i++, q += 8) {
+	    uint64_t u;
+	    memcpy(&u, q, 8);
+	    u = ((u & 0x00000000ffffffffULL) << 32)
+	          | ((u & 0xffffffff00000000ULL) >> 32);
+	    u = ((u & 0x0000ffff0000ffffULL) << 16)
+	          | ((u & 0xffff0000ffff0000ULL) >> 16);
+	    u = ((u & 0x00ff00ff00ff00ffULL) << 8)
+	          | ((u & 0xff00ff00ff00ff00ULL) >> 8);
+	    memcpy(q, &u, 8);
+	}
+	break;
+    default:
+	for (i = 0; i < n; i++, q += size)
+	    swapb(q, size);
+    }
+}
+
+/* Read up to n items of the given size into p, in blocks, swapping the
+   bytes in items of size swap (if non-zero) in each block just after
+   it is read.  Blocks are large for file connections, for which fread
+   transfers big blocks straight from the file, but otherwise small, to
+   avoid large buffers in the connection.  Returns the number of items
+   read. */
+
+#define BLOCK 8096
+#define FILE_BLOCK_BYTES (1 << 20)
+
+static int read_items(Rconnection con, void *p, int size, int n, int swap)
+{
+    char *pp = p;
+    int block, m0, m = 0;
+
+    block = strcmp(con->class, "file") == 0 ? FILE_BLOCK_BYTES / size
+                                             : BLOCK;
+    if (block < 1) block = 1;
+    while (n) {
+	int n1 = (n < block) ? n : block;
+	m0 = con->read(pp, size, n1, con);
+	if (swap) swap_items(pp, swap, m0 * (size / swap));
+	m += m0;
+	if (m0 < n1) break;
+	n -= n1;
+	pp += n1 * size;
+    }
+    return m;
+}
+
 static SEXP readOneString(Rconnection con)
 {
     char buf[10001], *p;
@@ -3686,7 +4270,6 @@ static SEXP rawOneString(Rbyte *bytes, int nbytes, int *np)
 }
 
 /* readBin(con, what, n, swap) */
-#define BLOCK 8096
 static SEXP do_readbin(SEXP call, SEXP op, SEXP args, SEXP env)
 {
     SEXP ans = R_NilValue, swhat;
@@ -3759,26 +4342,11 @@ static SEXP do_readbin(SEXP call, SEXP op, SEXP args, SEXP env)
 	    error(_("size changing is not supported for complex vectors"));
 	PROTECT(ans = allocVector(CPLXSXP, n));
 	p = (void *) COMPLEX(ans);
-	if(israw) m = rawRead(p, size, n, bytes, nbytes, &np);
-	else {
-	    /* Do this in blocks to avoid large buffers in the connection */
-	    char *pp = p;
-	    int m0, n0 = n;
-	    m = 0;
-	    while(n0) {
-		int n1 = (n0 < BLOCK) ? n0 : BLOCK;
-		m0 = con->read(pp, size, n1, con);
-		m += m0;
-		if (m0 < n1) break;
-		n0 -= n1;
-		pp += n1 * size;
-	    }
+	if(israw) {
+	    m = rawRead(p, size, n, bytes, nbytes, &np);
+	    if(swap) swap_items(p, sizeof(double), 2*m);
 	}
-	if(swap)
-	    for(i = 0; i < m; i++) {
-		swapb(&(COMPLEX(ans)[i].r), sizeof(double));
-		swapb(&(COMPLEX(ans)[i].i), sizeof(double));
-	    }
+	else m = read_items(con, p, size, n, swap ? sizeof(double) : 0);
     } else {
 	if (!strcmp(what, "integer") || !strcmp(what, "int")) {
 	    sizedef = sizeof(int); mode = 1;
@@ -3848,23 +4416,11 @@ static SEXP do_readbin(SEXP call, SEXP op, SEXP args, SEXP env)
 	if(!signd && (mode != 1 || size > 2))
 	    warning(_("'signed = FALSE' is only valid for integers of sizes 1 and 2"));
 	if(size == sizedef) {
-	    if(israw) m = rawRead(p, size, n, bytes, nbytes, &np);
-	    else {
-		/* Do this in blocks to avoid large buffers in the connection */
-		char *pp = p;
-		int m0, n0 = n;
-		m = 0;
-		while(n0) {
-		    int n1 = (n0 < BLOCK) ? n0 : BLOCK;
-		    m0 = con->read(pp, size, n1, con);
-		    m += m0;
-		    if (m0 < n1) break;
-		    n0 -= n1;
-		    pp += n1 * size;
-		}
+	    if(israw) {
+		m = rawRead(p, size, n, bytes, nbytes, &np);
+		if(swap) swap_items(p, size, m);
 	    }
-	    if(swap && size > 1)
-		for(i = 0; i < m; i++) swapb((char *)p+i*size, size);
+	    else m = read_items(con, p, size, n, swap ? size : 0);
 	} else {
 	    int s;
 	    union { 
@@ -3942,6 +4498,33 @@ static SEXP do_readbin(SEXP call, SEXP op, SEXP args, SEXP env)
     return ans;
 }
 
+/* Size of the items of an atomic vector as stored, and a pointer to
+   them.  Not for strings. */
+
+static int binary_item_size(SEXP x)
+{
+    switch(TYPEOF(x)) {
+    case LGLSXP:
+    case INTSXP:  return sizeof(int);
+    case REALSXP: return sizeof(double);
+    case CPLXSXP: return sizeof(Rcomplex);
+    case RAWSXP:  return 1;
+    default:      return 0;
+    }
+}
+
+static char *binary_item_data(SEXP x)
+{
+    switch(TYPEOF(x)) {
+    case LGLSXP:  return (char *) LOGICAL(x);
+    case INTSXP:  return (char *) INTEGER(x);
+    case REALSXP: return (char *) REAL(x);
+    case CPLXSXP: return (char *) COMPLEX(x);
+    case RAWSXP:  return (char *) RAW(x);
+    default:      return NULL;
+    }
+}
+
 /* writeBin(object, con, size, swap, useBytes) */
 static SEXP do_writebin(SEXP call, SEXP op, SEXP args, SEXP env)
 {
@@ -4037,6 +4620,28 @@ static SEXP do_writebin(SEXP call, SEXP op, SEXP args, SEXP env)
 		}
 	    }
 	}
+    } else if(!israw && (size == NA_INTEGER 
+                          || size == binary_item_size(object))) {
+	/* No conversion is needed, so write directly from the data, or
+	   if bytes must be swapped, from a buffer holding a block. */
+	char *data = binary_item_data(object);
+	size = binary_item_size(object);
+	if(!swap || size == 1)
+	    n = con->write(data, size, len, con);
+	else {
+	    int block = FILE_BLOCK_BYTES / size, n1, m0;
+	    int swapsize = TYPEOF(object) == CPLXSXP ? sizeof(double) : size;
+	    buf = R_chk_calloc(len < block ? len : block, size);
+	    for (n = 0; n < len; n += m0) {
+		n1 = len - n < block ? len - n : block;
+		memcpy(buf, data + (size_t) n * size, (size_t) n1 * size);
+		swap_items(buf, swapsize, n1 * (size / swapsize));
+		m0 = con->write(buf, size, n1, con);
+		if(m0 < n1) { n += m0; break; }
+	    }
+	    Free(buf);
+	}
+	if(n < len) warning(_("problem writing to connection"));
     } else {
 	switch(TYPEOF(object)) {
 	case LGLSXP:
@@ -4170,13 +4775,9 @@ static SEXP do_writebin(SEXP call, SEXP op, SEXP args, SEXP env)
 
 	if(swap && size > 1) {
 	    if (TYPEOF(object) == CPLXSXP)
-		for(i = 0; i < len; i++) {
-		    int sz = size/2;
-		    swapb(buf+sz*2*i, sz);
-		    swapb(buf+sz*(2*i+1), sz);
-		}
+		swap_items(buf, size/2, 2*len);
 	    else
-		for(i = 0; i < len; i++) swapb(buf+size*i, size);
+		swap_items(buf, size, len);
 	}
 
 	/* write it now */
@@ -4834,7 +5435,7 @@ static SEXP do_url(SEXP call, SEXP op, SEXP args, SEXP env)
     SEXP scmd, sopen, ans, class, enc;
     char *class2 = "url";
     const char *url, *open;
-    int ncon, block, raw = 0;
+    int ncon, block, raw = 0, prefetch = 0;
     cetype_t ienc = CE_NATIVE;
     Rconnection con = NULL;
 #ifdef HAVE_INTERNET
@@ -4884,6 +5485,9 @@ static SEXP do_url(SEXP call, SEXP op, SEXP args, SEXP env)
 	raw = asLogical(CAD4R(args));
 	if(raw == NA_LOGICAL)
 	    error(_("invalid '%s' argument"), "raw");
+	prefetch = asLogical(CAR(nthcdr(args, 5)));
+	if(prefetch == NA_LOGICAL)
+	    error(_("invalid '%s' argument"), "prefetch");
     }
 
     ncon = NextConnection();
@@ -4969,6 +5573,7 @@ static SEXP do_url(SEXP call, SEXP op, SEXP args, SEXP env)
 
     Connections[ncon] = con;
     con->blocking = block;
+    if(prefetch && strcmp(class2, "file") == 0) set_prefetch(con);
     strncpy(con->encname, CHAR(STRING_ELT(enc, 0)), 100); /* ASCII */
     con->encname[100 - 1] = '\0';
 
@@ -5832,9 +6437,9 @@ attribute_hidden FUNTAB R_FunTab_connections[] =
 
 {"fifo",	do_fifo,	0,      11,     4,      {PP_FUNCALL, PREC_FN,	0}},
 {"pipe",	do_pipe,	0,      11,     3,      {PP_FUNCALL, PREC_FN,	0}},
-{"gzfile",	do_gzfile,	0,      11,     4,      {PP_FUNCALL, PREC_FN,	0}},
-{"bzfile",	do_gzfile,	1,      11,     4,      {PP_FUNCALL, PREC_FN,	0}},
-{"xzfile",	do_gzfile,	2,      11,     4,      {PP_FUNCALL, PREC_FN,	0}},
+{"gzfile",	do_gzfile,	0,      11,     5,      {PP_FUNCALL, PREC_FN,	0}},
+{"bzfile",	do_gzfile,	1,      11,     5,      {PP_FUNCALL, PREC_FN,	0}},
+{"xzfile",	do_gzfile,	2,      11,     5,      {PP_FUNCALL, PREC_FN,	0}},
 {"stdin",	do_stdin,	0,      11,     0,      {PP_FUNCALL, PREC_FN,	0}},
 {"stdout",	do_stdout,	0,      11,     0,      {PP_FUNCALL, PREC_FN,	0}},
 {"stderr",	do_stderr,	0,      11,     0,      {PP_FUNCALL, PREC_FN,	0}},
@@ -5867,7 +6472,7 @@ attribute_hidden FUNTAB R_FunTab_connections[] =
 {"getAllConnections",do_getallconnections,0,11, 0,      {PP_FUNCALL, PREC_FN,	0}},
 {"getConnection",do_getconnection,0,	11,	1,      {PP_FUNCALL, PREC_FN,	0}},
 {"summary.connection",do_sumconnection,0,11,    1,      {PP_FUNCALL, PREC_FN,	0}},
-{"file",	do_url,		1,      11,     5,      {PP_FUNCALL, PREC_FN,	0}},
+{"file",	do_url,		1,      11,     6,      {PP_FUNCALL, PREC_FN,	0}},
 {"url",		do_url,		0,      11,     4,      {PP_FUNCALL, PREC_FN,	0}},
 {"gzcon",	do_gzcon,	0,      11,     3,      {PP_FUNCALL, PREC_FN,	0}},
 {"sockSelect",do_sockselect,	0,	11,     3,      {PP_FUNCALL, PREC_FN,	0}},
@@ -32,6 +32,8 @@
 #include <Defn.h>
 #include <Rmath.h>
 
+#include <helpers/helpers-app.h>
+
 
 #define COV_SUM_UPDATE				\
 		    sum += xm * ym;		\
@@ -118,34 +120,231 @@
 		ANS(i,j) = NA_REAL
 
 
-static void cov_pairwise1(int n, int ncx, double *x,
-			  double *ans, Rboolean *sd_0, Rboolean cor,
-			  Rboolean kendall)
+/* Information on a covariance/correlation computation that may be split
+   amongst helper tasks, stored in a raw vector, passed to task_cov.  The
+   columns of x for which results are computed are split amongst tasks,
+   each task doing the pairs with x columns in its range.  When sym is
+   TRUE, y is the same as x, and only pairs with j <= i are computed, 
+   with the result stored in both (i,j) and (j,i). */
+
+struct cov_info {
+    int n, ncx, ncy;            /* Number of rows and columns */
+    int n1;                     /* Divisor, when not pairwise */
+    Rboolean sym;               /* Result symmetric, y same as x? */
+    Rboolean pairwise;          /* Pairwise complete observations? */
+    Rboolean cor, kendall;      /* Correlation? Kendall's tau? */
+    double *x, *y;              /* Data */
+    double *xm, *ym;            /* Column means, when not pairwise */
+    int *ind;                   /* Rows to use, or NULL if all */
+    int *has_na_x, *has_na_y;   /* Columns with NA, or NULL if none */
+    double *ans;                /* Where to store the result */
+    Rboolean sd_0[HELPERS_MAX+1]; /* Set if task found a zero sd */
+};
+
+/* Compute pairwise results for x columns from i0 to i1-1. */
+
+static void cov_pairwise_cols (struct cov_info *info, int i0, int i1,
+                               Rboolean *sd_0)
 {
-    for (int i = 0 ; i < ncx ; i++) {
-	double *xx = &x[i * n];
-	for (int j = 0 ; j <= i ; j++) {
-	    double *yy = &x[j * n];
+    int n = info->n, ncx = info->ncx;
+    double *ans = info->ans;
+    Rboolean cor = info->cor, kendall = info->kendall;
+
+    for (int i = i0 ; i < i1 ; i++) {
+	double *xx = &info->x[(size_t) i * n];
+        int jend = info->sym ? i+1 : info->ncy;
+	for (int j = 0 ; j < jend ; j++) {
+	    double *yy = &info->y[(size_t) j * n];
 
 	    COV_PAIRWISE_BODY;
 
-	    ANS(j,i) = ANS(i,j);
+	    if (info->sym) ANS(j,i) = ANS(i,j);
 	}
     }
 }
 
+/* Compute covariances (not pairwise, not Kendall's tau) for x columns
+   from i0 to i1-1.  This is done for tiles of COV_TILE x columns by
+   COV_TILE y columns at once, so that each data value and each deviation
+   from the mean is used COV_TILE times once fetched.  The sums for each
+   pair are accumulated in the same order, with the same long double 
+   operations, as when pairs are done one at a time, so the results are
+   the same.  Columns are duplicated to fill out partial tiles.  Tiles
+   larger than 2 x 2 turn out to be slower, since the sums and deviations
+   then no longer all fit in (x87) registers. */
+
+#define COV_TILE 2
+
+static void cov_cross (struct cov_info *info, int i0, int i1)
+{
+    int n = info->n, ncx = info->ncx, n1 = info->n1;
+    int *ind = info->ind;
+    double *ans = info->ans;
+    int a, b, k;
+
+    for (int ib = i0 ; ib < i1 ; ib += COV_TILE) {
+
+        int ni = i1 - ib < COV_TILE ? i1 - ib : COV_TILE;
+        int jend = info->sym ? ib + ni : info->ncy;
+        long double xxm[COV_TILE];
+        double *xx[COV_TILE];
+
+        for (a = 0 ; a < COV_TILE ; a++) {
+            int i = a < ni ? ib + a : ib;
+            xx[a] = &info->x[(size_t) i * n];
+            xxm[a] = info->xm[i];
+        }
+
+        for (int jb = 0 ; jb < jend ; jb += COV_TILE) {
+
+            int nj = jend - jb < COV_TILE ? jend - jb : COV_TILE;
+            long double yym[COV_TILE], sum[COV_TILE][COV_TILE];
+            double *yy[COV_TILE];
+
+            for (b = 0 ; b < COV_TILE ; b++) {
+                int j = b < nj ? jb + b : jb;
+                yy[b] = &info->y[(size_t) j * n];
+                yym[b] = info->ym[j];
+                for (a = 0 ; a < COV_TILE ; a++)
+                    sum[a][b] = 0.;
+            }
+
+            for (k = 0 ; k < n ; k++) {
+                long double xd[COV_TILE], yd[COV_TILE];
+                if (ind != NULL && ind[k] == 0)
+                    continue;
+                for (a = 0 ; a < COV_TILE ; a++)
+                    xd[a] = xx[a][k] - xxm[a];
+                for (b = 0 ; b < COV_TILE ; b++)
+                    yd[b] = yy[b][k] - yym[b];
+                for (a = 0 ; a < COV_TILE ; a++)
+                    for (b = 0 ; b < COV_TILE ; b++)
+                        sum[a][b] += xd[a] * yd[b];
+            }
+
+            for (a = 0 ; a < ni ; a++) {
+                int i = ib + a;
+                for (b = 0 ; b < nj ; b++) {
+                    int j = jb + b;
+                    if (info->sym && j > i)
+                        break;
+                    double v = 
+                      info->has_na_x != NULL && info->has_na_x[i] 
+                       || info->has_na_y != NULL && info->has_na_y[j] 
+                        ? NA_REAL : sum[a][b] / n1;
+                    ANS(i,j) = v;
+                    if (info->sym) ANS(j,i) = v;
+                }
+            }
+        }
+    }
+}
+
+/* Task procedure for doing a portion of a covariance computation, with
+   the output being the result vector, and the input a raw vector with
+   a struct cov_info.  The op gives w (from 0) in its top bits and s-1 
+   in the next 8 bits (as for task_mvfft), for a computation split amongst 
+   s tasks.  Tasks other than the first wait for earlier tasks before 
+   finishing, so that the result is computed when the last one finishes. */
+
+void task_cov (helpers_op_t op, SEXP sans, SEXP sinfo, SEXP unused)
+{
+    int w = op >> 40;
+    int s = 1 + ((op >> 32) & 0xff);
+
+    struct cov_info *info = (struct cov_info *) RAW(sinfo);
+    int ncx = info->ncx;
+    int i0, i1;
+
+    /* With a symmetric result, the work for column i is proportional to
+       i+1, so the split points are chosen to balance the triangle. */
+
+    if (info->sym) {
+        i0 = w == 0 ? 0 : (int) (ncx * sqrt ((double) w / s));
+        i1 = w == s-1 ? ncx : (int) (ncx * sqrt ((double) (w+1) / s));
+    }
+    else {
+        i0 = (int) ((double) ncx * w / s);
+        i1 = (int) ((double) ncx * (w+1) / s);
+    }
+
+    if (info->pairwise)
+        cov_pairwise_cols (info, i0, i1, &info->sd_0[w]);
+    else
+        cov_cross (info, i0, i1);
+
+    if (w != 0) {
+        while (helpers_avail0(LENGTH(sans)) < LENGTH(sans)) ;
+    }
+}
+
+/* Do the computation described by *info, storing into sans, possibly
+   split amongst helper tasks.  Sets *sd_0 to TRUE if a zero standard
+   deviation was found (only for pairwise correlations). */
+
+#define T_cov_split THRESHOLD_ADJUST(20000) /* Min work for each task */
+
+static void cov_compute (struct cov_info *info, SEXP sans, Rboolean *sd_0)
+{
+    SEXP sinfo;
+    int w, s;
+
+    for (w = 0; w <= HELPERS_MAX; w++) 
+        info->sd_0[w] = FALSE;
+    info->ans = REAL(sans);
+
+    PROTECT(sinfo = allocVector (RAWSXP, sizeof *info));
+    memcpy (RAW(sinfo), info, sizeof *info);
+
+    double work = (double) info->n * info->ncx 
+                   * (info->sym ? (info->ncx + 1) / 2.0 : info->ncy);
+
+    s = helpers_not_multithreading_now ? 1 : helpers_num + 1;
+    if (s > info->ncx) s = info->ncx;
+    while (s > 1 && (double) s * T_cov_split > work) s -= 1;
+
+    if (s <= 1)
+        task_cov (0, sans, sinfo, (helpers_var_ptr)0);
+    else {
+        for (w = 0; w < s; w++)
+            helpers_do_task (w == 0   ? HELPERS_PIPE_OUT :
+                             w < s-1  ? HELPERS_PIPE_IN0_OUT 
+                                      : HELPERS_PIPE_IN0,
+                             task_cov,
+                             ((helpers_op_t)w<<40) | ((helpers_op_t)(s-1)<<32),
+                             sans, sinfo, (helpers_var_ptr)0);
+        WAIT_UNTIL_COMPUTED(sans);
+    }
+
+    info = (struct cov_info *) RAW(sinfo);
+    for (w = 0; w < s; w++)
+        if (info->sd_0[w]) *sd_0 = TRUE;
+
+    UNPROTECT(1);
+}
+
+static void cov_pairwise1(int n, int ncx, double *x,
+			  SEXP sans, Rboolean *sd_0, Rboolean cor,
+			  Rboolean kendall)
+{
+    struct cov_info info = { .n = n, .ncx = ncx, .ncy = ncx, 
+                             .sym = TRUE, .pairwise = TRUE, 
+                             .cor = cor, .kendall = kendall,
+                             .x = x, .y = x };
+
+    cov_compute (&info, sans, sd_0);
+}
+
 static void cov_pairwise2(int n, int ncx, int ncy, double *x, double *y,
-			  double *ans, Rboolean *sd_0, Rboolean cor,
+			  SEXP sans, Rboolean *sd_0, Rboolean cor,
 			  Rboolean kendall)
 {
-    for (int i = 0 ; i < ncx ; i++) {
-	double *xx = &x[i * n];
-	for (int j = 0 ; j < ncy ; j++) {
-	    double *yy = &y[j * n];
+    struct cov_info info = { .n = n, .ncx = ncx, .ncy = ncy, 
+                             .sym = FALSE, .pairwise = TRUE, 
+                             .cor = cor, .kendall = kendall,
+                             .x = x, .y = y };
 
-	    COV_PAIRWISE_BODY;
-	}
-    }
+    cov_compute (&info, sans, sd_0);
 }
 #undef COV_PAIRWISE_BODY
 
@@ -226,42 +425,32 @@ static void cov_pairwise2(int n, int ncx, int ncy, double *x, double *y,
 
 static void
 cov_complete1(int n, int ncx, double *x, double *xm,
-	      int *ind, double *ans, Rboolean *sd_0, Rboolean cor,
+	      int *ind, SEXP sans, Rboolean *sd_0, Rboolean cor,
 	      Rboolean kendall)
 {
+    double *ans = REAL(sans);
     COV_init(ncx);
 
     if(!kendall) {
 	MEAN(x);/* -> xm[] */
 	n1 = nobs - 1;
+        struct cov_info info = { .n = n, .ncx = ncx, .ncy = ncx, .n1 = n1,
+                                 .sym = TRUE, .x = x, .y = x, 
+                                 .xm = xm, .ym = xm, .ind = ind };
+        cov_compute (&info, sans, sd_0);
     }
-    for (i = 0 ; i < ncx ; i++) {
+    else for (i = 0 ; i < ncx ; i++) { /* Kendall's tau */
 	xx = &x[i * n];
-
-	if(!kendall) {
-	    xxm = xm[i];
-	    for (j = 0 ; j <= i ; j++) {
-		yy = &x[j * n];
-		yym = xm[j];
-		sum = 0.;
-		for (k = 0 ; k < n ; k++)
-		    if (ind[k] != 0)
-			sum += (xx[k] - xxm) * (yy[k] - yym);
-		ANS(j,i) = ANS(i,j) = sum / n1;
-	    }
-	}
-	else { /* Kendall's tau */
-	    for (j = 0 ; j <= i ; j++) {
-		yy = &x[j * n];
-		sum = 0.;
-		for (k = 0 ; k < n ; k++)
-		    if (ind[k] != 0)
-			for (n1 = 0 ; n1 < n ; n1++)
-			    if (ind[n1] != 0)
-				sum += sign(xx[k] - xx[n1])
-				     * sign(yy[k] - yy[n1]);
-		ANS(j,i) = ANS(i,j) = sum;
-	    }
+	for (j = 0 ; j <= i ; j++) {
+	    yy = &x[j * n];
+	    sum = 0.;
+	    for (k = 0 ; k < n ; k++)
+		if (ind[k] != 0)
+		    for (n1 = 0 ; n1 < n ; n1++)
+			if (ind[n1] != 0)
+			    sum += sign(xx[k] - xx[n1])
+				 * sign(yy[k] - yy[n1]);
+	    ANS(j,i) = ANS(i,j) = sum;
 	}
     }
 
@@ -287,51 +476,39 @@ cov_complete1(int n, int ncx, double *x, double *xm,
 
 static void
 cov_na_1(int n, int ncx, double *x, double *xm,
-	 int *has_na, double *ans, Rboolean *sd_0, Rboolean cor,
+	 int *has_na, SEXP sans, Rboolean *sd_0, Rboolean cor,
 	 Rboolean kendall)
 {
-
+    double *ans = REAL(sans);
     COV_ini_na(ncx);
 
     if(!kendall) {
 	MEAN_(x, has_na);/* -> xm[] */
 	n1 = n - 1;
+        struct cov_info info = { .n = n, .ncx = ncx, .ncy = ncx, .n1 = n1,
+                                 .sym = TRUE, .x = x, .y = x, 
+                                 .xm = xm, .ym = xm, 
+                                 .has_na_x = has_na, .has_na_y = has_na };
+        cov_compute (&info, sans, sd_0);
     }
-    for (i = 0 ; i < ncx ; i++) {
+    else for (i = 0 ; i < ncx ; i++) { /* Kendall's tau */
 	if(has_na[i]) {
 	    for (j = 0 ; j <= i ; j++)
 		ANS(j,i) = ANS(i,j) = NA_REAL;
 	}
 	else {
 	    xx = &x[i * n];
-
-	    if(!kendall) {
-		xxm = xm[i];
-		for (j = 0 ; j <= i ; j++)
-		    if(has_na[j]) {
-			ANS(j,i) = ANS(i,j) = NA_REAL;
-		    } else {
-			yy = &x[j * n];
-			yym = xm[j];
-			sum = 0.;
-			for (k = 0 ; k < n ; k++)
-			    sum += (xx[k] - xxm) * (yy[k] - yym);
-			ANS(j,i) = ANS(i,j) = sum / n1;
-		    }
-	    }
-	    else { /* Kendall's tau */
-		for (j = 0 ; j <= i ; j++)
-		    if(has_na[j]) {
-			ANS(j,i) = ANS(i,j) = NA_REAL;
-		    } else {
-			yy = &x[j * n];
-			sum = 0.;
-			for (k = 0 ; k < n ; k++)
-			    for (n1 = 0 ; n1 < n ; n1++)
-				sum += sign(xx[k] - xx[n1]) * sign(yy[k] - yy[n1]);
-			ANS(j,i) = ANS(i,j) = sum;
-		    }
-	    }
+	    for (j = 0 ; j <= i ; j++)
+		if(has_na[j]) {
+		    ANS(j,i) = ANS(i,j) = NA_REAL;
+		} else {
+		    yy = &x[j * n];
+		    sum = 0.;
+		    for (k = 0 ; k < n ; k++)
+			for (n1 = 0 ; n1 < n ; n1++)
+			    sum += sign(xx[k] - xx[n1]) * sign(yy[k] - yy[n1]);
+		    ANS(j,i) = ANS(i,j) = sum;
+		}
 	}
     }
 
@@ -358,41 +535,32 @@ cov_na_1(int n, int ncx, double *x, double *xm,
 static void
 cov_complete2(int n, int ncx, int ncy, double *x, double *y,
 	      double *xm, double *ym, int *ind,
-	      double *ans, Rboolean *sd_0, Rboolean cor, Rboolean kendall)
+	      SEXP sans, Rboolean *sd_0, Rboolean cor, Rboolean kendall)
 {
+    double *ans = REAL(sans);
     COV_init(ncy);
 
     if(!kendall) {
 	MEAN(x);/* -> xm[] */
 	MEAN(y);/* -> ym[] */
 	n1 = nobs - 1;
+        struct cov_info info = { .n = n, .ncx = ncx, .ncy = ncy, .n1 = n1,
+                                 .sym = FALSE, .x = x, .y = y, 
+                                 .xm = xm, .ym = ym, .ind = ind };
+        cov_compute (&info, sans, sd_0);
     }
-    for (i = 0 ; i < ncx ; i++) {
+    else for (i = 0 ; i < ncx ; i++) { /* Kendall's tau */
 	xx = &x[i * n];
-	if(!kendall) {
-	    xxm = xm[i];
-	    for (j = 0 ; j < ncy ; j++) {
-		yy = &y[j * n];
-		yym = ym[j];
-		sum = 0.;
-		for (k = 0 ; k < n ; k++)
-		    if (ind[k] != 0)
-			sum += (xx[k] - xxm) * (yy[k] - yym);
-		ANS(i,j) = sum / n1;
-	    }
-	}
-	else { /* Kendall's tau */
-	    for (j = 0 ; j < ncy ; j++) {
-		yy = &y[j * n];
-		sum = 0.;
-		for (k = 0 ; k < n ; k++)
-		    if (ind[k] != 0)
-			for (n1 = 0 ; n1 < n ; n1++)
-			    if (ind[n1] != 0)
-				sum += sign(xx[k] - xx[n1])
- 				    * sign(yy[k] - yy[n1]);
-		ANS(i,j) = sum;
-	    }
+	for (j = 0 ; j < ncy ; j++) {
+	    yy = &y[j * n];
+	    sum = 0.;
+	    for (k = 0 ; k < n ; k++)
+		if (ind[k] != 0)
+		    for (n1 = 0 ; n1 < n ; n1++)
+			if (ind[n1] != 0)
+			    sum += sign(xx[k] - xx[n1])
+				* sign(yy[k] - yy[n1]);
+	    ANS(i,j) = sum;
 	}
     }
 
@@ -440,49 +608,39 @@ cov_complete2(int n, int ncx, int ncy, double *x, double *y,
 static void
 cov_na_2(int n, int ncx, int ncy, double *x, double *y,
 	 double *xm, double *ym, int *has_na_x, int *has_na_y,
-	 double *ans, Rboolean *sd_0, Rboolean cor, Rboolean kendall)
+	 SEXP sans, Rboolean *sd_0, Rboolean cor, Rboolean kendall)
 {
+    double *ans = REAL(sans);
     COV_ini_na(ncy);
 
     if(!kendall) {
 	MEAN_(x, has_na_x);/* -> xm[] */
 	MEAN_(y, has_na_y);/* -> ym[] */
 	n1 = n - 1;
+        struct cov_info info = { .n = n, .ncx = ncx, .ncy = ncy, .n1 = n1,
+                                 .sym = FALSE, .x = x, .y = y, 
+                                 .xm = xm, .ym = ym, 
+                                 .has_na_x = has_na_x, .has_na_y = has_na_y };
+        cov_compute (&info, sans, sd_0);
     }
-    for (i = 0 ; i < ncx ; i++) {
+    else for (i = 0 ; i < ncx ; i++) { /* Kendall's tau */
 	if(has_na_x[i]) {
 	    for (j = 0 ; j < ncy; j++)
 		ANS(i,j) = NA_REAL;
 	}
 	else {
 	    xx = &x[i * n];
-	    if(!kendall) {
-		xxm = xm[i];
-		for (j = 0 ; j < ncy ; j++)
-		    if(has_na_y[j]) {
-			ANS(i,j) = NA_REAL;
-		    } else {
-			yy = &y[j * n];
-			yym = ym[j];
-			sum = 0.;
-			for (k = 0 ; k < n ; k++)
-			    sum += (xx[k] - xxm) * (yy[k] - yym);
-			ANS(i,j) = sum / n1;
-		    }
-	    }
-	    else { /* Kendall's tau */
-		for (j = 0 ; j < ncy ; j++)
-		    if(has_na_y[j]) {
-			ANS(i,j) = NA_REAL;
-		    } else {
-			yy = &y[j * n];
-			sum = 0.;
-			for (k = 0 ; k < n ; k++)
-			    for (n1 = 0 ; n1 < n ; n1++)
-				sum += sign(xx[k] - xx[n1]) * sign(yy[k] - yy[n1]);
-			ANS(i,j) = sum;
-		    }
-	    }
+	    for (j = 0 ; j < ncy ; j++)
+		if(has_na_y[j]) {
+		    ANS(i,j) = NA_REAL;
+		} else {
+		    yy = &y[j * n];
+		    sum = 0.;
+		    for (k = 0 ; k < n ; k++)
+			for (n1 = 0 ; n1 < n ; n1++)
+			    sum += sign(xx[k] - xx[n1]) * sign(yy[k] - yy[n1]);
+		    ANS(i,j) = sum;
+		}
 	}
     }
 
@@ -700,7 +858,7 @@ static SEXP do_cov(SEXP call, SEXP op, SEXP args, SEXP env)
 	    PROTECT(xm = allocVector(REALSXP, ncx));
 	    PROTECT(ind = allocVector(LGLSXP, ncx));
 	    find_na_1(n, ncx, REAL(x), /* --> has_na[] = */ LOGICAL(ind));
-	    cov_na_1 (n, ncx, REAL(x), REAL(xm), LOGICAL(ind), REAL(ans), &sd_0, cor, kendall);
+	    cov_na_1 (n, ncx, REAL(x), REAL(xm), LOGICAL(ind), ans, &sd_0, cor, kendall);
 
 	    UNPROTECT(2);
 	}
@@ -709,7 +867,7 @@ static SEXP do_cov(SEXP call, SEXP op, SEXP args, SEXP env)
 	    PROTECT(ind = allocVector(INTSXP, n));
 	    complete1(n, ncx, REAL(x), INTEGER(ind), na_fail);
 	    cov_complete1(n, ncx, REAL(x), REAL(xm),
-			  INTEGER(ind), REAL(ans), &sd_0, cor, kendall);
+			  INTEGER(ind), ans, &sd_0, cor, kendall);
 	    if(empty_err) {
 		Rboolean indany = FALSE;
 		for(i = 0; i < n; i++) {
@@ -720,7 +878,7 @@ static SEXP do_cov(SEXP call, SEXP op, SEXP args, SEXP env)
 	    UNPROTECT(2);
 	}
 	else {		/* pairwise "var" */
-	    cov_pairwise1(n, ncx, REAL(x), REAL(ans), &sd_0, cor, kendall);
+	    cov_pairwise1(n, ncx, REAL(x), ans, &sd_0, cor, kendall);
 	}
     }
     else { /* Co[vr] (x, y) */
@@ -733,7 +891,7 @@ static SEXP do_cov(SEXP call, SEXP op, SEXP args, SEXP env)
 
 	    find_na_2(n, ncx, ncy, REAL(x), REAL(y), INTEGER(ind), INTEGER(has_na_y));
 	    cov_na_2 (n, ncx, ncy, REAL(x), REAL(y), REAL(xm), REAL(ym),
-		      INTEGER(ind), INTEGER(has_na_y), REAL(ans), &sd_0, cor, kendall);
+		      INTEGER(ind), INTEGER(has_na_y), ans, &sd_0, cor, kendall);
 	    UNPROTECT(4);
 	}
 	else if (!pair) { /* all | complete */
@@ -742,7 +900,7 @@ static SEXP do_cov(SEXP call, SEXP op, SEXP args, SEXP env)
 	    PROTECT(ind = allocVector(INTSXP, n));
 	    complete2(n, ncx, ncy, REAL(x), REAL(y), INTEGER(ind), na_fail);
 	    cov_complete2(n, ncx, ncy, REAL(x), REAL(y), REAL(xm), REAL(ym),
-			  INTEGER(ind), REAL(ans), &sd_0, cor, kendall);
+			  INTEGER(ind), ans, &sd_0, cor, kendall);
 	    if(empty_err) {
 		Rboolean indany = FALSE;
 		for(i = 0; i < n; i++) {
@@ -753,7 +911,7 @@ static SEXP do_cov(SEXP call, SEXP op, SEXP args, SEXP env)
 	    UNPROTECT(3);
 	}
 	else {		/* pairwise */
-	    cov_pairwise2(n, ncx, ncy, REAL(x), REAL(y), REAL(ans),
+	    cov_pairwise2(n, ncx, ncy, REAL(x), REAL(y), ans,
 			  &sd_0, cor, kendall);
 	}
     }
@@ -31,45 +31,7 @@
 #define USE_FAST_PROTECT_MACROS
 #include "Defn.h"
 
-static void cumsum(SEXP x, SEXP s)
-{
-    int i;
-    R_len_t len = LENGTH(x);
-    double *rx = REAL(x), *rs = REAL(s);
-    long double sum = rx[0];
-    rs[0] = rx[0];
-    for (i = 1; i < len; i++) {
-        sum += rx[i];
-        rs[i] = sum;
-    }
-    if (ISNAN(rs[len-1])) { /* note: len is not zero */
-        for (i = 0; i < len; i++)
-            if (ISNA(rx[i]))
-                break;
-        for ( ; i < len; i++)
-            rs[i] = NA_REAL;
-    }
-}
-
-static void icumsum(SEXP x, SEXP s)
-{
-    int i;
-    R_len_t len = LENGTH(x);
-    int *ix = INTEGER(x), *is = INTEGER(s);
-    int64_t sum = 0;
-    for (i = 0; i < len; i++) {
-        if (ix[i] == NA_INTEGER) break;
-        sum += ix[i];
-        /* We need to ensure that overflow gives NA here */
-        if (sum > INT_MAX || sum < 1 + INT_MIN) { /* INT_MIN is NA_INTEGER */
-            warning(_("Integer overflow in 'cumsum'; use 'cumsum(as.numeric(.))'"));
-            break;
-        }
-        is[i] = sum;
-    }
-    for ( ; i < len; i++)
-        is[i] = NA_INTEGER;
-}
+#include <helpers/helpers-app.h>
 
 static void ccumsum(SEXP x, SEXP s)
 {
@@ -86,26 +48,6 @@ static void ccumsum(SEXP x, SEXP s)
     }
 }
 
-static void cumprod(SEXP x, SEXP s)
-{
-    int i;
-    R_len_t len = LENGTH(x);
-    double *rx = REAL(x), *rs = REAL(s);
-    long double prod = rx[0];
-    rs[0] = rx[0];
-    for (i = 1; i < len; i++) {
-        prod *= rx[i];
-        rs[i] = prod;
-    }
-    if (ISNAN(rs[len-1])) { /* note: len is not zero */
-        for (i = 0; i < len; i++)
-            if (ISNA(rx[i]))
-                break;
-        for ( ; i < len; i++)
-            rs[i] = NA_REAL;
-    }
-}
-
 static void ccumprod(SEXP x, SEXP s)
 {
     int i;
@@ -121,89 +63,494 @@ static void ccumprod(SEXP x, SEXP s)
     }
 }
 
-static void cummax(SEXP x, SEXP s)
+/* Cumulative sums, products, maximums, and minimums of real and integer
+   vectors are found for blocks of CUM_BLOCK elements.  The result for an
+   element is found from the elements before it in its block and a "carry"
+   state for the start of the block, which is found from summaries of the
+   earlier blocks.  For sums and products of reals, the carry is the long
+   double sum (or product) of the long double sums (or products) of the
+   earlier blocks, to which the sum (or product) of elements in the block
+   is accumulated, also as a long double.  For vectors of length at most
+   CUM_BLOCK, this is the same as a simple sequential accumulation.  For
+   integers, and for maximums and minimums, results are exact, and hence
+   always the same as for sequential computation.
+
+   Since the carries depend only on summaries of blocks, the blocks can be
+   split amongst several helper tasks, after the summaries have been found
+   (also in parallel) by other tasks, with results that don't depend on
+   how many tasks are used. */
+
+#define CUM_BLOCK 65536
+
+#define CUM_SUM  1      /* Operations, as in PRIMVAL for do_cum */
+#define CUM_PROD 2
+#define CUM_MAX  3
+#define CUM_MIN  4
+
+#define CUM_INT  8      /* Flag for integer (or logical) operand */
+
+/* Summary of a block of elements. */
+
+struct cum_summary {
+    long double r;      /* Sum or product of reals in block */
+    int64_t i;          /* Sum of integers in block before any NA */
+    int64_t ilo, ihi;   /* Min and max of partial sums of integers */
+    double e;           /* Max or min of reals before any NaN */
+    double nan, na;     /* First NaN in block, first NA in block */
+    int ie;             /* Max or min of integers before any NA */
+    char has_nan;       /* Is there a NaN in block? */
+    char has_na;        /* Is there an NA in block? */
+};
+
+/* State at the start of a block. */
+
+struct cum_state {
+    long double r;      /* Sum or product of reals so far */
+    int64_t i;          /* Sum of integers so far */
+    double e;           /* Max or min of reals, or NaN or NA once seen */
+    int ie;             /* Max or min of integers so far */
+    char first;         /* Is this the start of the first block? */
+    char nan, na;       /* Has a NaN or NA been seen? */
+    char ovf;           /* Has there been integer overflow? */
+};
+
+/* Space for summaries used by tasks, with header. */
+
+struct cum_info {
+    int ovf;            /* Set to whether overflow occurred by last task */
+};
+
+#define CUM_SUMMARIES(sblk) \
+    ((struct cum_summary *) \
+      (((uintptr_t) RAW(sblk) + sizeof (struct cum_info) + 15) & ~(uintptr_t)15))
+
+#define CUM_PICK(max,a,b) \
+    ((max) ? ((a) > (b) ? (a) : (b)) : ((a) < (b) ? (a) : (b)))
+
+static void cum_init (int op, struct cum_state *c)
 {
-    double max = R_NegInf;
-    R_len_t len = LENGTH(x);
-    int i;
-    double *rx = REAL(x), *rs = REAL(s);
-    for (i = 0; i < len; i++) {
-        if (ISNAN(rx[i])) {
-            max = rx[i];
-            break;
+    int max = (op & 7) == CUM_MAX;
+
+    c->r = 0;
+    c->i = 0;
+    c->e = max ? R_NegInf : R_PosInf;
+    c->ie = max ? INT_MIN : INT_MAX;
+    c->first = 1;
+    c->nan = c->na = c->ovf = 0;
+}
+
+/* Find the summary for elements from-to (excluding to) of x. */
+
+static void cum_summary (int op, SEXP x, R_len_t from, R_len_t to,
+                         struct cum_summary *b)
+{
+    int max = (op & 7) == CUM_MAX;
+    R_len_t i;
+
+    b->has_nan = b->has_na = 0;
+
+    switch (op) {
+
+    case CUM_SUM: case CUM_PROD: {
+        double *rx = REAL(x);
+        long double r = rx[from];
+        if (op == CUM_SUM)
+            for (i = from+1; i < to; i++) r += rx[i];
+        else
+            for (i = from+1; i < to; i++) r *= rx[i];
+        b->r = r;
+        if (ISNAN(r)) {
+            for (i = from; i < to; i++)
+                if (ISNA(rx[i])) {
+                    b->has_na = 1;
+                    break;
+                }
         }
-        max = max > rx[i] ? max : rx[i];
-        rs[i] = max;
+        break;
     }
-    for ( ; i < len; i++) {
-        if (ISNA(rx[i])) {
-            max = rx[i];
-            break;
+
+    case CUM_MAX: case CUM_MIN: {
+        double *rx = REAL(x);
+        double e = max ? R_NegInf : R_PosInf;
+        for (i = from; i < to; i++) {
+            if (ISNAN(rx[i])) break;
+            e = CUM_PICK (max, e, rx[i]);
+        }
+        b->e = e;
+        if (i < to) {
+            b->has_nan = 1;
+            b->nan = rx[i];
+            for ( ; i < to; i++)
+                if (ISNA(rx[i])) {
+                    b->has_na = 1;
+                    b->na = rx[i];
+                    break;
+                }
         }
-        rs[i] = max;
+        break;
+    }
+
+    case CUM_INT+CUM_SUM: {
+        int *ix = INTEGER(x);
+        int64_t sum = 0, lo = 0, hi = 0;
+        for (i = from; i < to; i++) {
+            if (ix[i] == NA_INTEGER) {
+                b->has_na = 1;
+                break;
+            }
+            sum += ix[i];
+            if (sum < lo) lo = sum;
+            else if (sum > hi) hi = sum;
+        }
+        b->i = sum;
+        b->ilo = lo;
+        b->ihi = hi;
+        break;
+    }
+
+    case CUM_INT+CUM_MAX: case CUM_INT+CUM_MIN: {
+        int *ix = INTEGER(x);
+        int e = max ? INT_MIN : INT_MAX;
+        for (i = from; i < to; i++) {
+            if (ix[i] == NA_INTEGER) {
+                b->has_na = 1;
+                break;
+            }
+            e = CUM_PICK (max, e, ix[i]);
+        }
+        b->ie = e;
+        break;
+    }
     }
-    for ( ; i < len; i++)
-        rs[i] = max;
 }
 
-static void cummin(SEXP x, SEXP s)
+/* Update the state c to the end of a block with summary b.  Must give
+   exactly the same result as cum_scan does for that block. */
+
+static void cum_fold (int op, struct cum_state *c, struct cum_summary *b)
 {
-    double min = R_PosInf;
-    R_len_t len = LENGTH(x);
-    int i;
-    double *rx = REAL(x), *rs = REAL(s);
-    for (i = 0; i < len; i++) {
-        if (ISNAN(rx[i])) {
-            min = rx[i];
+    int max = (op & 7) == CUM_MAX;
+
+    switch (op) {
+
+    case CUM_SUM: case CUM_PROD:
+        c->r = c->first ? b->r : op == CUM_SUM ? c->r + b->r : c->r * b->r;
+        if (b->has_na) c->na = 1;
+        break;
+
+    case CUM_MAX: case CUM_MIN:
+        if (c->na)
             break;
+        if (!c->nan) {
+            c->e = CUM_PICK (max, c->e, b->e);
+            if (b->has_nan) {
+                c->nan = 1;
+                c->e = b->nan;
+            }
+        }
+        if (b->has_na) {
+            c->na = 1;
+            c->e = b->na;
         }
-        min = min < rx[i] ? min : rx[i];
-        rs[i] = min;
+        break;
+
+    case CUM_INT+CUM_SUM:
+        if (c->na || c->ovf)
+            break;
+        if (c->i + b->ihi > INT_MAX || c->i + b->ilo < 1 + INT_MIN)
+            c->ovf = 1;   /* INT_MIN is NA_INTEGER */
+        else if (b->has_na)
+            c->na = 1;
+        else
+            c->i += b->i;
+        break;
+
+    case CUM_INT+CUM_MAX: case CUM_INT+CUM_MIN:
+        if (c->na)
+            break;
+        c->ie = CUM_PICK (max, c->ie, b->ie);
+        if (b->has_na)
+            c->na = 1;
+        break;
     }
-    for ( ; i < len; i++) {
-        if (ISNA(rx[i])) {
-            min = rx[i];
+
+    c->first = 0;
+}
+
+/* Store results for elements from-to (excluding to) of x in s, given
+   state c at the start, updating c to the state at the end. */
+
+static void cum_scan (int op, SEXP x, SEXP s, R_len_t from, R_len_t to,
+                      struct cum_state *c)
+{
+    int max = (op & 7) == CUM_MAX;
+    R_len_t i;
+
+    switch (op) {
+
+    case CUM_SUM: case CUM_PROD: {
+        double *rx = REAL(x), *rs = REAL(s);
+        long double r, rb;  /* from start of vector, and from start of block */
+        i = from;
+        if (c->na) {
+            for ( ; i < to; i++) rs[i] = NA_REAL;
             break;
         }
-        rs[i] = min;
+        rb = rx[i];
+        r = c->first ? rb : op == CUM_SUM ? c->r + rx[i] : c->r * rx[i];
+        rs[i] = r;
+        if (op == CUM_SUM) {
+            for (i = from+1; i < to; i++) {
+                r += rx[i];
+                rb += rx[i];
+                rs[i] = r;
+            }
+            c->r = c->first ? rb : c->r + rb;
+        }
+        else {
+            for (i = from+1; i < to; i++) {
+                r *= rx[i];
+                rb *= rx[i];
+                rs[i] = r;
+            }
+            c->r = c->first ? rb : c->r * rb;
+        }
+        if (ISNAN(rs[to-1])) {
+            for (i = from; i < to; i++)
+                if (ISNA(rx[i]))
+                    break;
+            if (i < to) {
+                c->na = 1;
+                for ( ; i < to; i++)
+                    rs[i] = NA_REAL;
+            }
+        }
+        break;
+    }
+
+    case CUM_MAX: case CUM_MIN: {
+        double *rx = REAL(x), *rs = REAL(s);
+        double e = c->e;
+        i = from;
+        if (!c->nan && !c->na) {
+            for ( ; i < to; i++) {
+                if (ISNAN(rx[i])) {
+                    c->nan = 1;
+                    e = rx[i];
+                    break;
+                }
+                e = CUM_PICK (max, e, rx[i]);
+                rs[i] = e;
+            }
+        }
+        if (!c->na) {
+            for ( ; i < to; i++) {
+                if (ISNA(rx[i])) {
+                    c->na = 1;
+                    e = rx[i];
+                    break;
+                }
+                rs[i] = e;
+            }
+        }
+        for ( ; i < to; i++)
+            rs[i] = e;
+        c->e = e;
+        break;
+    }
+
+    case CUM_INT+CUM_SUM: {
+        int *ix = INTEGER(x), *is = INTEGER(s);
+        int64_t sum = c->i;
+        i = from;
+        if (!c->na && !c->ovf) {
+            for ( ; i < to; i++) {
+                if (ix[i] == NA_INTEGER) {
+                    c->na = 1;
+                    break;
+                }
+                sum += ix[i];
+                /* We need to ensure that overflow gives NA here */
+                if (sum > INT_MAX || sum < 1 + INT_MIN) { /* INT_MIN is NA */
+                    c->ovf = 1;
+                    break;
+                }
+                is[i] = sum;
+            }
+            c->i = sum;
+        }
+        for ( ; i < to; i++)
+            is[i] = NA_INTEGER;
+        break;
     }
-    for ( ; i < len; i++)
-        rs[i] = min;
+
+    case CUM_INT+CUM_MAX: case CUM_INT+CUM_MIN: {
+        int *ix = INTEGER(x), *is = INTEGER(s);
+        int e = c->ie;
+        i = from;
+        if (!c->na) {
+            for ( ; i < to; i++) {
+                if (ix[i] == NA_INTEGER) {
+                    c->na = 1;
+                    break;
+                }
+                e = CUM_PICK (max, e, ix[i]);
+                is[i] = e;
+            }
+            c->ie = e;
+        }
+        for ( ; i < to; i++)
+            is[i] = NA_INTEGER;
+        break;
+    }
+    }
+
+    c->first = 0;
 }
 
-static void icummax(SEXP x, SEXP s)
+/* Task procedure to find summaries of blocks, split amongst tasks.  The
+   operation is encoded as for task_cum.  The number of summaries is one
+   less than the number of blocks, since the last block's isn't needed. */
+
+void task_cum_summary (helpers_op_t op, SEXP sblk, SEXP x, SEXP ignored)
 {
+    int cop = op & 0xf;
+    int w = op >> 40;
+    int ns = 1 + ((op >> 32) & 0xff);
+
     R_len_t len = LENGTH(x);
-    int *ix = INTEGER(x), *is = INTEGER(s);
-    int i;
-    int max = INT_MIN;
-    for (i = 0; i < len; i++) {
-        if (ix[i] == NA_INTEGER)
-            break;
-        max = max > ix[i] ? max : ix[i];
-        is[i] = max;
+    R_len_t nsum = (len - 1) / CUM_BLOCK;
+    R_len_t b0 = (R_len_t) ((double) nsum * w / ns);
+    R_len_t b1 = (R_len_t) ((double) nsum * (w+1) / ns);
+    struct cum_summary *sum = CUM_SUMMARIES(sblk);
+    R_len_t b;
+
+    for (b = b0; b < b1; b++)
+        cum_summary (cop, x, (R_len_t) b * CUM_BLOCK,
+                     (R_len_t) b * CUM_BLOCK + CUM_BLOCK, sum+b);
+
+    if (w != 0) {
+        while (helpers_avail0(LENGTH(sblk)) < LENGTH(sblk)) ;
     }
-    for ( ; i < len; i++)
-        is[i] = NA_INTEGER;
 }
 
-static void icummin(SEXP x, SEXP s)
+/* Task procedure for a cumulative operation, possibly split amongst tasks,
+   each doing a range of blocks.  The operation code has the operation
+   (with CUM_INT flag) in the low four bits, the task index, w, in bits 40
+   and up, and the number of tasks, ns, minus one in bits 32 to 39.  The
+   summaries found by task_cum_summary are in sblk (not needed, and may be
+   null, when w is zero).
+
+   Output is pipelined, with the amount produced by a task other than the
+   first being that produced by the tasks before it, until these tasks have
+   finished their part of the vector. */
+
+void task_cum (helpers_op_t op, SEXP s, SEXP x, SEXP sblk)
 {
-    R_len_t len = LENGTH(x);
-    int *ix = INTEGER(x), *is = INTEGER(s);
-    int i;
-    int min = INT_MAX;
-    for (i = 0; i < len; i++ ) {
-        if (ix[i] == NA_INTEGER)
-            break;
-        min = min < ix[i] ? min : ix[i];
-        is[i] = min;
+    int cop = op & 0xf;
+    int w = op >> 40;
+    int ns = 1 + ((op >> 32) & 0xff);
+
+    R_len_t len = LENGTH(s);
+    R_len_t nblk = (len - 1) / CUM_BLOCK + 1;
+    R_len_t b0 = (R_len_t) ((double) nblk * w / ns);
+    R_len_t b1 = (R_len_t) ((double) nblk * (w+1) / ns);
+    R_len_t start = b0 * CUM_BLOCK;
+    R_len_t from, to, a;
+    struct cum_state c;
+    R_len_t b;
+
+    cum_init (cop, &c);
+    for (b = 0; b < b0; b++)
+        cum_fold (cop, &c, CUM_SUMMARIES(sblk) + b);
+
+    to = start;
+    for (b = b0; b < b1; b++) {
+        from = to;
+        to = len - from > CUM_BLOCK ? from + CUM_BLOCK : len;
+        cum_scan (cop, x, s, from, to, &c);
+        if (w == 0)
+            helpers_amount_out (to);
+        else {
+            a = helpers_avail0 (len);
+            helpers_amount_out (a < start ? a : to);
+        }
+    }
+
+    if (w != 0) {
+        while ((a = helpers_avail0(len)) < len)
+            helpers_amount_out (a < start ? a : to);
+    }
+
+    if (w == ns-1 && sblk != NULL)
+        ((struct cum_info *) RAW(sblk)) -> ovf = c.ovf;
+}
+
+/* Do a cumulative operation for a real or integer vector, t, putting the
+   result in s.  The operation may be done by a single task, or be split
+   amongst helpers, except that a single integer sum is done in the master,
+   since it may produce a warning. */
+
+#define T_cum THRESHOLD_ADJUST(20)
+
+static void cum_real_or_int (SEXP call, int cop, SEXP t, SEXP s, int variant)
+{
+    R_len_t len = LENGTH(t);
+    R_len_t nblk = (len - 1) / CUM_BLOCK + 1;
+    int ns, w;
+
+    ns = helpers_not_multithreading_now ? 1 : helpers_num + 1;
+    if (ns > nblk / 2) ns = nblk / 2;  /* at least two blocks per task */
+
+    if (ns <= 1) {
+        if (cop == CUM_INT+CUM_SUM) {
+            struct cum_state c;
+            R_len_t from, to;
+            cum_init (cop, &c);
+            for (from = 0; from < len; from = to) {
+                to = len - from > CUM_BLOCK ? from + CUM_BLOCK : len;
+                cum_scan (cop, t, s, from, to, &c);
+            }
+            if (c.ovf)
+                warning (
+                 _("Integer overflow in 'cumsum'; use 'cumsum(as.numeric(.))'"));
+        }
+        else
+            DO_NOW_OR_LATER1 (variant, len >= T_cum, HELPERS_PIPE_OUT,
+                              task_cum, cop, s, t);
+    }
+
+    else {
+        SEXP sblk;
+        PROTECT(sblk = allocVector (RAWSXP, sizeof (struct cum_info) + 16
+                                  + (nblk-1) * sizeof (struct cum_summary)));
+        for (w = 0; w < ns; w++)
+            helpers_do_task (w == 0   ? HELPERS_PIPE_OUT :
+                             w < ns-1 ? HELPERS_PIPE_IN0_OUT
+                                      : HELPERS_PIPE_IN0,
+                             task_cum_summary,
+                             ((helpers_op_t)w<<40) | ((helpers_op_t)(ns-1)<<32)
+                               | cop,
+                             sblk, t, (helpers_var_ptr)0);
+        for (w = 0; w < ns; w++)
+            helpers_do_task (w == 0 ? HELPERS_PIPE_OUT : HELPERS_PIPE_IN0_OUT,
+                             task_cum,
+                             ((helpers_op_t)w<<40) | ((helpers_op_t)(ns-1)<<32)
+                               | cop,
+                             s, t, w == 0 ? (helpers_var_ptr)0 : sblk);
+        if (cop == CUM_INT+CUM_SUM) {
+            WAIT_UNTIL_COMPUTED(s);
+            if (((struct cum_info *) RAW(sblk)) -> ovf)
+                warning (
+                 _("Integer overflow in 'cumsum'; use 'cumsum(as.numeric(.))'"));
+        }
+        else if (! (variant & VARIANT_PENDING_OK))
+            WAIT_UNTIL_COMPUTED(s);
+        UNPROTECT(1);
     }
-    for ( ; i < len; i++)
-        is[i] = NA_INTEGER;
 }
 
-static SEXP do_cum(SEXP call, SEXP op, SEXP args, SEXP env)
+static SEXP do_cum(SEXP call, SEXP op, SEXP args, SEXP env, int variant)
 {
     SEXP s, t, ans;
 
@@ -238,19 +585,9 @@ static SEXP do_cum(SEXP call, SEXP op, SEXP args, SEXP env)
         PROTECT(s = allocVector(INTSXP, LENGTH(t)));
         setAttrib(s, R_NamesSymbol, getNamesAttrib(t));
         if (LENGTH(t) == 0) { UNPROTECT(2); return s; }
-        switch (PRIMVAL(op) ) {
-        case 1: /* cumsum */
-            icumsum(t,s);  /* may produce a warning, which allocates */
-            break;
-        case 3: /* cummax */
-            icummax(t,s);
-            break;
-        case 4: /* cummin */
-            icummin(t,s);
-            break;
-        default:
+        if (PRIMVAL(op) < 1 || PRIMVAL(op) > 4)
             errorcall(call, _("unknown cumxxx function"));
-        }
+        cum_real_or_int (call, CUM_INT + PRIMVAL(op), t, s, variant);
     }
 
     else {
@@ -258,22 +595,9 @@ static SEXP do_cum(SEXP call, SEXP op, SEXP args, SEXP env)
         PROTECT(s = allocVector(REALSXP, LENGTH(t)));
         setAttrib(s, R_NamesSymbol, getNamesAttrib(t));
         if (LENGTH(t) == 0) { UNPROTECT(2); return s; }
-        switch (PRIMVAL(op) ) {
-        case 1: /* cumsum */
-            cumsum(t,s);
-            break;
-        case 2: /* cumprod */
-            cumprod(t,s);
-            break;
-        case 3: /* cummax */
-            cummax(t,s);
-            break;
-        case 4: /* cummin */
-            cummin(t,s);
-            break;
-        default:
+        if (PRIMVAL(op) < 1 || PRIMVAL(op) > 4)
             errorcall(call, _("unknown cumxxx function"));
-        }
+        cum_real_or_int (call, PRIMVAL(op), t, s, variant);
     }
 
     UNPROTECT(2);  /* t, s */
@@ -286,10 +610,10 @@ attribute_hidden FUNTAB R_FunTab_cum[] =
 {
 /* printname	c-entry		offset	eval	arity	pp-kind	     precedence	rightassoc */
 
-{"cumsum",	do_cum,		1,	1,	1,	{PP_FUNCALL, PREC_FN,	0}},
-{"cumprod",	do_cum,		2,	1,	1,	{PP_FUNCALL, PREC_FN,	0}},
-{"cummax",	do_cum,		3,	1,	1,	{PP_FUNCALL, PREC_FN,	0}},
-{"cummin",	do_cum,		4,	1,	1,	{PP_FUNCALL, PREC_FN,	0}},
+{"cumsum",	do_cum,		1,	1001,	1,	{PP_FUNCALL, PREC_FN,	0}},
+{"cumprod",	do_cum,		2,	1001,	1,	{PP_FUNCALL, PREC_FN,	0}},
+{"cummax",	do_cum,		3,	1001,	1,	{PP_FUNCALL, PREC_FN,	0}},
+{"cummin",	do_cum,		4,	1001,	1,	{PP_FUNCALL, PREC_FN,	0}},
 
 {NULL,		NULL,		0,	0,	0,	{PP_INVALID, PREC_FN,	0}}
 };
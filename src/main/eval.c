@@ -40,6 +40,8 @@
 
 #include <helpers/helpers-app.h>
 
+#include <time.h>
+
 
 #ifndef SCALAR_STACK_DEBUG    /* can be overridden by compiler option */
 #define SCALAR_STACK_DEBUG 0
@@ -714,6 +716,166 @@ static SEXP attribute_noinline evalv_sym (SEXP sym, SEXP rho, int variant)
 }
 
 
+/* COUNTS AND TIMES FOR PRIMITIVES.  When enabled with Rprofcounts (which
+   sets R_PrimCounting), calls of primitives from evalv_other and of 
+   internals from do_internal are counted, and the elapsed time for each
+   call is recorded, both in total and excluding time in primitives
+   called from within it (the "self" time).  The self time is found by
+   keeping track of the total time in completed calls within the current
+   one, in prim_child_time.  A call exited by a longjmp is not counted. 
+
+   Times are from a monotonic clock, in nanoseconds, when one is available. */
+
+static struct prim_count {
+    double calls;      /* Number of calls */
+    uint64_t time;     /* Total elapsed time in calls */
+    uint64_t self;     /* Time excluding that in primitives called within */
+} prim_counts[R_MAX_FUNTAB_ENTRIES];
+
+static uint64_t prim_child_time;  /* Time in completed calls at this level */
+
+static inline uint64_t prim_clock (void)
+{
+#if defined(HAVE_CLOCK_GETTIME) && defined(CLOCK_MONOTONIC)
+    struct timespec ts;
+    clock_gettime (CLOCK_MONOTONIC, &ts);
+    return (uint64_t) ts.tv_sec * 1000000000 + ts.tv_nsec;
+#else
+    extern double currentTime(void); /* from datetime.c */
+    return (uint64_t) (currentTime() * 1e9);
+#endif
+}
+
+void attribute_hidden R_prim_count_begin (R_prim_timing *t)
+{
+    t->child = prim_child_time;
+    t->start = prim_clock();
+}
+
+void attribute_hidden R_prim_count_end (R_prim_timing *t, SEXP op)
+{
+    uint64_t elapsed = prim_clock() - t->start;
+    struct prim_count *p = &prim_counts[PRIMOFFSET(op)];
+
+    p->calls += 1;
+    p->time += elapsed;
+    p->self += elapsed - (prim_child_time - t->child);
+
+    prim_child_time = t->child + elapsed;
+}
+
+/* .Internal(Rprofcounts(enable,reset)) enables or disables counting for
+   primitives and helper tasks, and optionally resets the counts to zero.
+   Returns whether counting was previously enabled. */
+
+static SEXP do_Rprofcounts (SEXP call, SEXP op, SEXP args, SEXP rho)
+{
+    int enable, reset, old;
+
+    checkArity(op,args);
+    enable = asLogical(CAR(args));
+    reset = asLogical(CADR(args));
+    if (enable == NA_LOGICAL || reset == NA_LOGICAL)
+        error(_("invalid '%s' argument"), enable == NA_LOGICAL ? "enable" 
+                                                                : "reset");
+
+    old = R_PrimCounting;
+
+    if (reset) {
+        memset (prim_counts, 0, sizeof prim_counts);
+        helpers_timing_reset();
+    }
+
+    R_PrimCounting = enable;
+    helpers_timing (enable);
+
+    return ScalarLogical(old);
+}
+
+/* .Internal(getRprofcounts(tasks)) returns a list of vectors giving the
+   counts for primitives (tasks FALSE) or helper tasks (tasks TRUE).  Only
+   primitives that were called at least once, or tasks that were done at
+   least once, are included.  Times are returned in seconds. */
+
+static SEXP do_getRprofcounts (SEXP call, SEXP op, SEXP args, SEXP rho)
+{
+    SEXP res, names;
+    int tasks, n, i, j;
+
+    checkArity(op,args);
+    tasks = asLogical(CAR(args));
+    if (tasks == NA_LOGICAL)
+        error(_("invalid '%s' argument"), "tasks");
+
+    if (!tasks) {
+
+        static const char *nms[] = 
+          { "name", "type", "internal", "calls", "time", "self.time" };
+
+        n = 0;
+        for (i = 0; R_FunTab[i].name; i++)
+            if (prim_counts[i].calls > 0) n += 1;
+
+        PROTECT(res = allocVector (VECSXP, 6));
+        for (j = 0; j < 6; j++)
+            SET_VECTOR_ELT (res, j, allocVector (j < 2 ? STRSXP 
+                                                : j == 2 ? LGLSXP : REALSXP, n));
+
+        j = 0;
+        for (i = 0; R_FunTab[i].name; i++) {
+            struct prim_count *p = &prim_counts[i];
+            if (p->calls == 0) continue;
+            SET_STRING_ELT (VECTOR_ELT(res,0), j, mkChar(R_FunTab[i].name));
+            SET_STRING_ELT (VECTOR_ELT(res,1), j, 
+              mkChar (R_FunTab[i].eval % 10 == 1 ? "builtin" : "special"));
+            LOGICAL(VECTOR_ELT(res,2))[j] = (R_FunTab[i].eval % 100) / 10;
+            REAL(VECTOR_ELT(res,3))[j] = p->calls;
+            REAL(VECTOR_ELT(res,4))[j] = p->time * 1e-9;
+            REAL(VECTOR_ELT(res,5))[j] = p->self * 1e-9;
+            j += 1;
+        }
+
+        PROTECT(names = allocVector (STRSXP, 6));
+        for (j = 0; j < 6; j++)
+            SET_STRING_ELT (names, j, mkChar(nms[j]));
+    }
+
+    else {
+
+        static const char *nms[] = { "name", "master.now", "master", 
+                                     "helper", "merged", "elements", "time" };
+        struct helpers_timing_entry *e;
+
+        n = helpers_timing_table (&e);
+
+        PROTECT(res = allocVector (VECSXP, 7));
+        SET_VECTOR_ELT (res, 0, allocVector (STRSXP, n));
+        for (j = 1; j < 7; j++)
+            SET_VECTOR_ELT (res, j, allocVector (REALSXP, n));
+
+        for (i = 0; i < n; i++) {
+            SET_STRING_ELT (VECTOR_ELT(res,0), i, 
+                            mkChar (Rf_task_name (e[i].proc)));
+            REAL(VECTOR_ELT(res,1))[i] = e[i].master_now;
+            REAL(VECTOR_ELT(res,2))[i] = e[i].master;
+            REAL(VECTOR_ELT(res,3))[i] = e[i].helper;
+            REAL(VECTOR_ELT(res,4))[i] = e[i].merged;
+            REAL(VECTOR_ELT(res,5))[i] = e[i].elements;
+            REAL(VECTOR_ELT(res,6))[i] = e[i].time;
+        }
+
+        PROTECT(names = allocVector (STRSXP, 7));
+        for (j = 0; j < 7; j++)
+            SET_STRING_ELT (names, j, mkChar(nms[j]));
+    }
+
+    setAttrib (res, R_NamesSymbol, names);
+
+    UNPROTECT(2);
+    return res;
+}
+
+
 /* Evaluate an expression that is not a symbol (other than ..., ..1, ..2, etc.)
    such as language objects, promises, and self-evaluating expressions. 
    (Most often called with language objects.) */
@@ -751,12 +913,17 @@ static SEXP attribute_noinline evalv_other (SEXP e, SEXP rho, int variant)
         else {
             int save = R_PPStackTop;
             const void *vmax = VMAXGET();
+            int counting = R_PrimCounting;
+            R_prim_timing timing;
 
 #           ifdef Win32
                 /* Reset precision, rounding & exception modes of an ix86 fpu */
                 __asm__ ( "fninit" );
 #           endif
 
+            if (counting)
+                R_prim_count_begin (&timing);
+
             /* Note: If called from evalv, R_Visible will've been set to TRUE */
             if (type_etc == SPECIALSXP) {
                 /* Note:  Special primitives always take variant argument,
@@ -781,6 +948,9 @@ static SEXP attribute_noinline evalv_other (SEXP e, SEXP rho, int variant)
             else
                 apply_non_function_error();
 
+            if (counting)
+                R_prim_count_end (&timing, op);
+
             CHECK_STACK_BALANCE(op, save);
             VMAXSET(vmax);
         }
@@ -5106,9 +5276,17 @@ static SEXP do_subassign(SEXP call, SEXP op, SEXP args, SEXP rho, int variant)
 
             else {
 
-                /* Do the very simplest cases here. */
+                /* Do the very simplest cases here.  These include storing
+                   a logical or integer scalar into an integer or real vector
+                   (as in for (i in 1:n) x[i] <- i), which don't change the
+                   type of x. */
+
+                int ytype = TYPE_ETC(y);  /* scalar, no attributes, if type */
 
-                if (isVectorAtomic(x) && TYPEOF(x) == TYPE_ETC(y)) {
+                if (isVectorAtomic(x) && (TYPEOF(x) == ytype
+                     || TYPEOF(x) == REALSXP && (ytype == INTSXP 
+                                                  || ytype == LGLSXP)
+                     || TYPEOF(x) == INTSXP && ytype == LGLSXP)) {
                     R_len_t len = LENGTH(x);
                     R_len_t ix = 0;
                     if (TYPE_ETC(sb1) == INTSXP && *INTEGER(sb1) >= 1
@@ -5126,7 +5304,9 @@ static SEXP do_subassign(SEXP call, SEXP op, SEXP args, SEXP rho, int variant)
                                 INTEGER(x)[ix] = *INTEGER(y);
                                 break;
                             case REALSXP:
-                                REAL(x)[ix] = *REAL(y);
+                                REAL(x)[ix] = ytype == REALSXP ? *REAL(y)
+                                  : *INTEGER(y) == NA_INTEGER ? NA_REAL
+                                  : *INTEGER(y);
                                 break;
                             case CPLXSXP:
                                 COMPLEX(x)[ix] = *COMPLEX(y);
@@ -5407,6 +5587,8 @@ attribute_hidden FUNTAB R_FunTab_eval[] =
 {"Recall",	do_recall,	0,	210,	-1,	{PP_FUNCALL, PREC_FN,	  0}},
 
 {"withVisible", do_withVisible,	1,	10,	1,	{PP_FUNCALL, PREC_FN,	0}},
+{"Rprofcounts",	do_Rprofcounts,	0,	11,	2,	{PP_FUNCALL, PREC_FN,	0}},
+{"getRprofcounts",do_getRprofcounts,0,	11,	1,	{PP_FUNCALL, PREC_FN,	0}},
 
 /* Logical Operators, all primitives */
 /* these are group generic and so need to eval args (as builtin or themselves)*/
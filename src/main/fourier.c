@@ -25,7 +25,7 @@
  */
 
 /* These are the R interface routines to the plain FFT code
-   fft_factor() & fft_work() in ../appl/fft.c. */
+   fft_plan_factor() & fft_plan_work() in ../appl/fft.c. */
 
 #ifdef HAVE_CONFIG_H
 #include <config.h>
@@ -35,12 +35,33 @@
 #include "Defn.h"
 #include <R_ext/Applic.h>
 
+#include <helpers/helpers-app.h>
+
+
+/* Get the factorization of n needed for an FFT, signalling an error if it
+   can't be done.  The plan for the last length used is kept, so repeated
+   transforms of the same length (which are common) don't refactor. */
+
+static fft_plan cached_plan;
+
+static const fft_plan *get_plan (int n)
+{
+    if (cached_plan.n != n || n == 0) {
+        fft_plan_factor (&cached_plan, n);
+        if (cached_plan.maxf == 0)
+            error(_("fft factorization error"));
+    }
+
+    return &cached_plan;
+}
+
 /* Fourier Transform for Univariate Spatial and Time Series */
 
 static SEXP do_fft(SEXP call, SEXP op, SEXP args, SEXP env)
 {
     SEXP z, d;
-    int i, inv, maxf, maxmaxf, maxmaxp, maxp, n, ndims, nseg, nspn;
+    int i, inv, maxmaxf, maxmaxp, n, ndims, nseg, nspn;
+    const fft_plan *plan;
     double *work;
     int *iwork;
 
@@ -74,13 +95,11 @@ static SEXP do_fft(SEXP call, SEXP op, SEXP args, SEXP env)
     if (LENGTH(z) > 1) {
 	if (isNull(d = getDimAttrib(z))) {  /* temporal transform */
 	    n = length(z);
-	    fft_factor(n, &maxf, &maxp);
-	    if (maxf == 0)
-		error(_("fft factorization error"));
-	    work = (double*)R_alloc(4 * maxf, sizeof(double));
-	    iwork = (int*)R_alloc(maxp, sizeof(int));
-	    fft_work(&(COMPLEX(z)[0].r), &(COMPLEX(z)[0].i),
-		     1, n, 1, inv, work, iwork);
+	    plan = get_plan(n);
+	    work = (double*)R_alloc(4 * plan->maxf, sizeof(double));
+	    iwork = (int*)R_alloc(plan->maxp, sizeof(int));
+	    fft_plan_work(plan, &(COMPLEX(z)[0].r), &(COMPLEX(z)[0].i),
+			  1, 1, inv, work, iwork);
 	}
 	else {					     /* spatial transform */
 	    maxmaxf = 1;
@@ -89,13 +108,11 @@ static SEXP do_fft(SEXP call, SEXP op, SEXP args, SEXP env)
 	    /* do whole loop just for error checking and maxmax[fp] .. */
 	    for (i = 0; i < ndims; i++) {
 		if (INTEGER(d)[i] > 1) {
-		    fft_factor(INTEGER(d)[i], &maxf, &maxp);
-		    if (maxf == 0)
-			error(_("fft factorization error"));
-		    if (maxf > maxmaxf)
-			maxmaxf = maxf;
-		    if (maxp > maxmaxp)
-			maxmaxp = maxp;
+		    plan = get_plan(INTEGER(d)[i]);
+		    if (plan->maxf > maxmaxf)
+			maxmaxf = plan->maxf;
+		    if (plan->maxp > maxmaxp)
+			maxmaxp = plan->maxp;
 		}
 	    }
 	    work = (double*)R_alloc(4 * maxmaxf, sizeof(double));
@@ -108,9 +125,9 @@ static SEXP do_fft(SEXP call, SEXP op, SEXP args, SEXP env)
 		    nspn *= n;
 		    n = INTEGER(d)[i];
 		    nseg /= n;
-		    fft_factor(n, &maxf, &maxp);
-		    fft_work(&(COMPLEX(z)[0].r), &(COMPLEX(z)[0].i),
-			     nseg, n, nspn, inv, work, iwork);
+		    plan = get_plan(n);
+		    fft_plan_work(plan, &(COMPLEX(z)[0].r), &(COMPLEX(z)[0].i),
+				  nseg, nspn, inv, work, iwork);
 		}
 	    }
 	}
@@ -122,12 +139,54 @@ static SEXP do_fft(SEXP call, SEXP op, SEXP args, SEXP env)
 /* Fourier Transform for Vector-Valued ("multivariate") Series */
 /* Not to be confused with the spatial case (in do_fft). */
 
+/* Task procedure for transforming the columns of z in place.  The columns
+   may be split amongst s tasks, with task w (from 0) doing a portion.  
+   The op gives w in its top bits, s-1 in the next 8 bits, and whether the
+   inverse transform is done in the low bit.  The ws input is a raw vector
+   containing the fft_plan, followed by the work areas for the s tasks. 
+   Tasks other than the first wait for earlier tasks before finishing, so
+   that z is computed when the last task finishes. */
+
+#define MVFFT_OP(w,s,inv) \
+    (((helpers_op_t)(w)<<40) | ((helpers_op_t)((s)-1)<<32) | ((inv) > 0))
+
+void task_mvfft (helpers_op_t op, SEXP z, SEXP ws, SEXP unused)
+{
+    int w = op >> 40;
+    int s = 1 + ((op >> 32) & 0xff);
+    int isn = (op & 1) ? 2 : -2;
+
+    const fft_plan *plan = (const fft_plan *) RAW(ws);
+    double *works = (double *) (RAW(ws) + sizeof (fft_plan));
+    double *work = works + (size_t) w * 4 * plan->maxf;
+    int *iwork = (int *) (works + (size_t) s * 4 * plan->maxf) 
+                   + (size_t) w * plan->maxp;
+
+    int n = plan->n;
+    int p = LENGTH(z) / n;
+    int j0 = (int) ((double) p * w / s);
+    int j1 = (int) ((double) p * (w+1) / s);
+    Rcomplex *c = COMPLEX(z);
+
+    for (int j = j0; j < j1; j++)
+        fft_plan_work (plan, &c[(size_t)j*n].r, &c[(size_t)j*n].i,
+                       1, 1, isn, work, iwork);
+
+    if (w != 0) {
+        while (helpers_avail0(LENGTH(z)) < LENGTH(z)) ;
+    }
+}
+
+/* Minimum number of elements transformed for each task that the columns 
+   are split amongst. */
+
+#define T_mvfft_split THRESHOLD_ADJUST(2000)
+
 static SEXP do_mvfft(SEXP call, SEXP op, SEXP args, SEXP env)
 {
     SEXP z, d;
-    int i, inv, maxf, maxp, n, p;
-    double *work;
-    int *iwork;
+    int i, inv, n, p;
+    const fft_plan *plan;
 
     checkArity(op, args);
 
@@ -161,16 +220,37 @@ static SEXP do_mvfft(SEXP call, SEXP op, SEXP args, SEXP env)
     else inv = 2;
 
     if (n > 1) {
-	fft_factor(n, &maxf, &maxp);
-	if (maxf == 0)
-	    error(_("fft factorization error"));
-	work = (double*)R_alloc(4 * maxf, sizeof(double));
-	iwork = (int*)R_alloc(maxp, sizeof(int));
-	for (i = 0; i < p; i++) {
-	    fft_factor(n, &maxf, &maxp);
-	    fft_work(&(COMPLEX(z)[i*n].r), &(COMPLEX(z)[i*n].i),
-		     1, n, 1, inv, work, iwork);
-	}
+
+	plan = get_plan(n);
+
+        /* Decide how many tasks to split the columns amongst. */
+
+        int s = helpers_not_multithreading_now ? 1 : helpers_num + 1;
+        if (s > p) s = p;
+        while (s > 1 && (double) s * T_mvfft_split > (double) n * p) s -= 1;
+
+        if (s <= 1) {
+            double *work = (double*)R_alloc(4 * plan->maxf, sizeof(double));
+            int *iwork = (int*)R_alloc(plan->maxp, sizeof(int));
+            for (i = 0; i < p; i++)
+                fft_plan_work(plan, &(COMPLEX(z)[(size_t)i*n].r), 
+                              &(COMPLEX(z)[(size_t)i*n].i),
+                              1, 1, inv, work, iwork);
+        }
+        else {
+            SEXP ws = allocVector (RAWSXP, sizeof (fft_plan) 
+                        + (size_t) s * 4 * plan->maxf * sizeof (double)
+                        + (size_t) s * plan->maxp * sizeof (int));
+            memcpy (RAW(ws), plan, sizeof (fft_plan));
+            WAIT_UNTIL_COMPUTED(z);
+            for (int w = 0; w < s; w++)
+                helpers_do_task (w == 0   ? HELPERS_PIPE_OUT :
+                                 w < s-1  ? HELPERS_PIPE_IN0_OUT 
+                                          : HELPERS_PIPE_IN0,
+                                 task_mvfft, MVFFT_OP(w,s,inv), 
+                                 z, ws, (helpers_var_ptr)0);
+            WAIT_UNTIL_COMPUTED(z);
+        }
     }
     UNPROTECT(1);
     return z;
@@ -194,6 +194,49 @@ static int gc_ran_finalizers;          /* Whether finalizers ran in last GC */
 static int gc_reporting = 0;           /* Should message be printed on GC? */
 
 
+/* Record of recent garbage collections, for gc.history and gc.hook.
+   Records are kept in a circular buffer, and are always made, since the
+   cost is small compared to that of a collection. */
+
+#define GC_HISTORY_SIZE 256    /* Number of collections recorded */
+
+#define GC_TRIGGER_REQUESTED 0 /* Things that can trigger a collection */
+#define GC_TRIGGER_LARGE     1
+#define GC_TRIGGER_BIG       2
+#define GC_TRIGGER_COUNTS    3
+#define GC_TRIGGER_PERIODIC  4
+#define GC_TRIGGER_SPACE     5
+#define GC_TRIGGER_TORTURE   6
+
+static const char * const gc_trigger_names[] =
+{ "requested", "large allocation", "big objects", "object counts",
+  "periodic full", "space needed", "gctorture"
+};
+
+static struct gc_record {
+    long long int count;        /* Number of this collection (from 1) */
+    double time;                /* Time collection started (as Sys.time) */
+    double pause;               /* Elapsed time for collection (seconds) */
+    double interval;            /* Time from end of previous collection */
+    double allocated;           /* Objects allocated since previous one */
+    int level;                  /* Level of collection (0, 1, or 2) */
+    int trigger;                /* What triggered it (GC_TRIGGER_...) */
+    unsigned before[3], after[3];   /* Objects in each generation */
+    size_t big_before[3], big_after[3]; /* Chunks in big objects, each gen */
+    size_t mem_before, mem_after;   /* Total memory usage, in bytes */
+    unsigned segments;              /* Total segments in use after */
+    double recovery[3];             /* Recovery fractions after collection */
+    unsigned kind_segments[SGGC_N_KINDS]; /* Segments in use for each kind */
+} gc_history[GC_HISTORY_SIZE];
+
+static long long int gc_history_count = 0; /* Number of records ever made */
+static double gc_last_end = 0;       /* Time at end of last collection */
+static int gc_auto_trigger;           /* Trigger set by gc_strategy */
+
+static SEXP gc_hook = R_NilValue;     /* R function to call after each GC */
+static int gc_in_hook = 0;            /* Set while hook is being called */
+
+
 /* Declarations relating to GC torture
 
    **** if the user specified a wait before starting to force
@@ -622,6 +665,7 @@ void sggc_find_root_ptrs (void)
         &R_Srcref,                /* Current source reference */
 
         &R_PreciousList,
+        &gc_hook,                 /* Function called after each GC */
         0
     };
 
@@ -1092,6 +1136,7 @@ static void gc_strategy (sggc_nchunks_t nch)
                      && nch > 0.7 * total_big_chunks) {
         if (DEBUG_STRATEGY) REprintf("GC from large allocation\n");
         gc_next_level = 2;
+        gc_auto_trigger = GC_TRIGGER_LARGE;
         goto collect;
     }
 
@@ -1108,16 +1153,19 @@ static void gc_strategy (sggc_nchunks_t nch)
         if (sggc_info.gen0_big_chunks > 3.0 * sggc_info.gen1_big_chunks) {
             if (DEBUG_STRATEGY) REprintf("GC from big chunks level 0\n");
             gc_next_level = 0;
+            gc_auto_trigger = GC_TRIGGER_BIG;
             goto collect;
         }
         else if (sggc_info.gen1_big_chunks > 0.5 * sggc_info.gen2_big_chunks) {
             if (DEBUG_STRATEGY) REprintf("GC from big chunks level 1\n");
             gc_next_level = 1;
+            gc_auto_trigger = GC_TRIGGER_BIG;
             goto collect;
         }
         else if (total_big_chunks > 3.0 * gc_big_chunks_last_full) {
             if (DEBUG_STRATEGY) REprintf("GC from big chunks level 2\n");
             gc_next_level = 2;
+            gc_auto_trigger = GC_TRIGGER_BIG;
             goto collect;
         }
     }
@@ -1131,17 +1179,20 @@ static void gc_strategy (sggc_nchunks_t nch)
         if ((gc_count-gc_count_last_full) * recovery_frac2 > 4.0) {
             if (DEBUG_STRATEGY) REprintf("GC from counts level 2\n");
             gc_next_level = 2;
+            gc_auto_trigger = GC_TRIGGER_COUNTS;
             goto collect;
         }
         else if (sggc_info.gen1_count * recovery_frac1 
              > 0.1 * (sggc_info.gen1_count + sggc_info.gen2_count)) {
             if (DEBUG_STRATEGY) REprintf("GC from counts level 1\n");
             gc_next_level = 1;
+            gc_auto_trigger = GC_TRIGGER_COUNTS;
             goto collect;
         }
         else {
             if (DEBUG_STRATEGY) REprintf("GC from counts level 0\n");
             gc_next_level = 0;
+            gc_auto_trigger = GC_TRIGGER_COUNTS;
             goto collect;
         }
     }
@@ -1155,6 +1206,7 @@ static void gc_strategy (sggc_nchunks_t nch)
     if (gc_next_level < 2 && gc_count - gc_count_last_full > 100) {
         if (DEBUG_STRATEGY) REprintf("Changed to level 2 by count\n");
         gc_next_level = 2;
+        gc_auto_trigger = GC_TRIGGER_PERIODIC;
     }
 
     R_gc_internal(1,R_NoObject);
@@ -2174,6 +2226,7 @@ void R_gc(void)
 }
 
 extern double R_getClockIncrement(void);
+extern double currentTime(void);
 extern void R_getProcTime(double *data);
 
 static double gctimes[5], gcstarttimes[5];
@@ -2266,6 +2319,210 @@ void lphash_free (void *ptr)
 }
 
 
+/* Make a record of a garbage collection just done, in gc_history. */
+
+static void record_gc (int reason, struct sggc_info *old, 
+                       double start_time, double end_time)
+{
+    struct gc_record *r = &gc_history[gc_history_count % GC_HISTORY_SIZE];
+    sggc_kind_t k;
+
+    gc_history_count += 1;
+
+    r->count = gc_count;
+    r->time = start_time;
+    r->pause = end_time - start_time;
+    r->interval = gc_last_end == 0 ? NA_REAL : start_time - gc_last_end;
+    r->allocated = old->allocations - old->allocations_at_last_gc;
+    r->level = gc_last_level;
+    r->trigger = reason == 0 ? GC_TRIGGER_REQUESTED :
+                 reason == 1 ? gc_auto_trigger :
+                 reason == 2 ? GC_TRIGGER_SPACE : 
+                               GC_TRIGGER_TORTURE;
+
+    r->before[0] = old->gen0_count; 
+    r->before[1] = old->gen1_count; 
+    r->before[2] = old->gen2_count;
+    r->after[0] = sggc_info.gen0_count; 
+    r->after[1] = sggc_info.gen1_count; 
+    r->after[2] = sggc_info.gen2_count;
+
+    r->big_before[0] = old->gen0_big_chunks; 
+    r->big_before[1] = old->gen1_big_chunks; 
+    r->big_before[2] = old->gen2_big_chunks;
+    r->big_after[0] = sggc_info.gen0_big_chunks; 
+    r->big_after[1] = sggc_info.gen1_big_chunks; 
+    r->big_after[2] = sggc_info.gen2_big_chunks;
+
+    r->mem_before = old->total_mem_usage;
+    r->mem_after = sggc_info.total_mem_usage;
+    r->segments = sggc_info.n_segments;
+
+    r->recovery[0] = recovery_frac0;
+    r->recovery[1] = recovery_frac1;
+    r->recovery[2] = recovery_frac2;
+
+    for (k = 0; k < SGGC_N_KINDS; k++)
+        r->kind_segments[k] = sggc_kind_segments[k];
+
+    gc_last_end = end_time;
+}
+
+/* Names of the values for a GC record, as put in a vector by 
+   gc_record_values below. */
+
+#define GC_N_VALUES 25
+#define GC_TRIGGER_VALUE 3      /* Index of the trigger code */
+
+static const char * const gc_value_names[GC_N_VALUES] =
+{ "count", "time", "level", "trigger", "pause", "interval", "allocated",
+  "marked.0", "marked.1", "marked.2", "freed.0", "freed.1", "freed.2",
+  "big.marked.0", "big.marked.1", "big.marked.2", 
+  "big.freed.0", "big.freed.1", "big.freed.2",
+  "memory.before", "memory.after", "segments",
+  "recovery.0", "recovery.1", "recovery.2"
+};
+
+/* Find the numbers marked and freed in each generation from the numbers
+   in each generation before and after a collection at the given level.
+   Survivors of a collection move up a generation.  For a full collection,
+   generations 1 and 2 are combined, with the result reported as for 
+   generation 2.  Generations not collected are given NA. */
+
+static void gc_marked_freed (int level, const double *before, 
+                             const double *after, double *marked, 
+                             double *freed)
+{
+    marked[0] = level == 0 ? after[1] - before[1] : after[1];
+    freed[0] = before[0] - marked[0];
+
+    marked[1] = freed[1] = marked[2] = freed[2] = NA_REAL;
+
+    if (level == 1) {
+        marked[1] = after[2] - before[2];
+        freed[1] = before[1] - marked[1];
+    }
+    else if (level == 2) {
+        marked[2] = after[2];
+        freed[2] = before[1] + before[2] - after[2];
+    }
+}
+
+/* Put the values for a GC record in v, which has length GC_N_VALUES. 
+   Sizes of big objects are converted from chunks to bytes. */
+
+static void gc_record_values (const struct gc_record *r, double *v)
+{
+    double before[3], after[3];
+    int g;
+
+    v[0] = r->count;
+    v[1] = r->time;
+    v[2] = r->level;
+    v[3] = r->trigger;
+    v[4] = r->pause;
+    v[5] = r->interval;
+    v[6] = r->allocated;
+
+    for (g = 0; g < 3; g++) {
+        before[g] = r->before[g];
+        after[g] = r->after[g];
+    }
+    gc_marked_freed (r->level, before, after, v+7, v+10);
+
+    for (g = 0; g < 3; g++) {
+        before[g] = (double) r->big_before[g] * SGGC_CHUNK_SIZE;
+        after[g] = (double) r->big_after[g] * SGGC_CHUNK_SIZE;
+    }
+    gc_marked_freed (r->level, before, after, v+13, v+16);
+
+    v[19] = r->mem_before;
+    v[20] = r->mem_after;
+    v[21] = r->segments;
+    v[22] = r->recovery[0];
+    v[23] = r->recovery[1];
+    v[24] = r->recovery[2];
+}
+
+/* Names for kinds of segments, of the form "T.C", where T is the SGGC type
+   and C is the number of chunks, or "big" for kinds used for big objects.
+   These names need not be unique. */
+
+static SEXP gc_kind_names (void)
+{
+    SEXP nms = allocVector (STRSXP, SGGC_N_KINDS);
+    char buf[30];
+    sggc_kind_t k;
+
+    PROTECT(nms);
+    for (k = 0; k < SGGC_N_KINDS; k++) {
+        if (sggc_kind_chunks[k] == 0)
+            sprintf (buf, "%d.big", k % SGGC_N_TYPES);
+        else
+            sprintf (buf, "%d.%d", k % SGGC_N_TYPES, sggc_kind_chunks[k]);
+        SET_STRING_ELT (nms, k, mkChar(buf));
+    }
+    UNPROTECT(1);
+    return nms;
+}
+
+/* Call the hook function set by gc.hook with a list describing the last
+   collection.  As for finalizers, a top level context is established so
+   that errors do not spill into the call that triggered the collection.
+   The hook is not called for collections done while it is running. */
+
+static void run_gc_hook (void)
+{
+    const struct gc_record *r = 
+      &gc_history[(gc_history_count-1) % GC_HISTORY_SIZE];
+    RCNTXT thiscontext;
+    RCNTXT * volatile saveToplevelContext;
+    volatile int savestack;
+    volatile SEXP topExp;
+    SEXP info, nms, segs, e;
+    double v[GC_N_VALUES];
+    int i;
+
+    gc_in_hook = 1;
+
+    begincontext(&thiscontext, CTXT_TOPLEVEL, R_NilValue, R_GlobalEnv,
+                 R_BaseEnv, R_NilValue, R_NilValue);
+    saveToplevelContext = R_ToplevelContext;
+    PROTECT(topExp = R_CurrentExpr);
+    savestack = R_PPStackTop;
+    if (! SETJMP(thiscontext.cjmpbuf)) {
+        R_GlobalContext = R_ToplevelContext = &thiscontext;
+
+        gc_record_values (r, v);
+        PROTECT(info = allocVector (VECSXP, GC_N_VALUES+1));
+        PROTECT(nms = allocVector (STRSXP, GC_N_VALUES+1));
+        for (i = 0; i < GC_N_VALUES; i++) {
+            SET_STRING_ELT (nms, i, mkChar(gc_value_names[i]));
+            SET_VECTOR_ELT (info, i, i == GC_TRIGGER_VALUE 
+                                      ? mkString(gc_trigger_names[r->trigger])
+                                      : ScalarReal(v[i]));
+        }
+        SET_STRING_ELT (nms, GC_N_VALUES, mkChar("kinds"));
+        segs = allocVector (INTSXP, SGGC_N_KINDS);
+        SET_VECTOR_ELT (info, GC_N_VALUES, segs);
+        for (i = 0; i < SGGC_N_KINDS; i++)
+            INTEGER(segs)[i] = r->kind_segments[i];
+        setAttrib (segs, R_NamesSymbol, gc_kind_names());
+        setAttrib (info, R_NamesSymbol, nms);
+
+        PROTECT(e = LCONS (gc_hook, CONS (info, R_NilValue)));
+        eval (e, R_GlobalEnv);
+        UNPROTECT(3);
+    }
+    endcontext(&thiscontext);
+    R_ToplevelContext = saveToplevelContext;
+    R_PPStackTop = savestack;
+    R_CurrentExpr = topExp;
+    UNPROTECT(1);
+
+    gc_in_hook = 0;
+}
+
 /* Main GC procedure.  Arguments are the reason for collection (0=requested,
    1=automatic, 2=space needed, 3=gctorture) and a vector in which to store 
    type counts, or R_NoObject if this is not to be done. */
@@ -2273,6 +2530,7 @@ void lphash_free (void *ptr)
 static void R_gc_internal (int reason, SEXP counters)
 {
     struct sggc_info old_sggc_info = sggc_info;
+    double start_time, end_time;
 
     helpers_release_holds();
 
@@ -2290,6 +2548,8 @@ static void R_gc_internal (int reason, SEXP counters)
           gc_count, gc_count_last_full, (unsigned)gc_big_chunks_last_full);
     }
 
+    start_time = currentTime();
+
     BEGIN_SUSPEND_INTERRUPTS {
 
 	gc_start_timing();
@@ -2308,10 +2568,14 @@ static void R_gc_internal (int reason, SEXP counters)
 
     } END_SUSPEND_INTERRUPTS;
 
+    end_time = currentTime();
+
     update_strategy_data(old_sggc_info);
 
     gc_last_level = gc_next_level;
 
+    record_gc (reason, &old_sggc_info, start_time, end_time);
+
     gc_next_level = 2;  /* just in case - should be changed before next call */
 
     if (gc_reporting || DEBUG_STRATEGY) {
@@ -2343,6 +2607,80 @@ static void R_gc_internal (int reason, SEXP counters)
     }
 
     gc_ran_finalizers = RunFinalizers();
+
+    if (gc_hook != R_NilValue && !gc_in_hook)
+        run_gc_hook();
+}
+
+/* .Internal(gc.history(n,kinds)) returns a list with a matrix of values
+   for the last n garbage collections (all recorded if n is NA), oldest
+   first, with the trigger as a code, and either NULL or a matrix of 
+   counts of segments in use for each kind. */
+
+static SEXP do_gchistory(SEXP call, SEXP op, SEXP args, SEXP rho)
+{
+    SEXP ans, vals, segs, dn;
+    double v[GC_N_VALUES];
+    long long int first;
+    int n, kinds, i, j;
+
+    checkArity(op, args);
+    n = asInteger(CAR(args));
+    kinds = asLogical(CADR(args));
+
+    if (n == NA_INTEGER || n > gc_history_count)
+        n = gc_history_count;
+    if (n > GC_HISTORY_SIZE)
+        n = GC_HISTORY_SIZE;
+    if (n < 0)
+        n = 0;
+    first = gc_history_count - n;
+
+    PROTECT(ans = allocVector (VECSXP, 2));
+
+    vals = allocMatrix (REALSXP, n, GC_N_VALUES);
+    SET_VECTOR_ELT (ans, 0, vals);
+    for (i = 0; i < n; i++) {
+        gc_record_values (&gc_history[(first+i) % GC_HISTORY_SIZE], v);
+        for (j = 0; j < GC_N_VALUES; j++)
+            REAL(vals)[i + (R_xlen_t)j*n] = v[j];
+    }
+    dn = allocVector (VECSXP, 2);
+    setAttrib (vals, R_DimNamesSymbol, dn);
+    SET_VECTOR_ELT (dn, 1, allocVector (STRSXP, GC_N_VALUES));
+    for (j = 0; j < GC_N_VALUES; j++)
+        SET_STRING_ELT (VECTOR_ELT(dn,1), j, mkChar(gc_value_names[j]));
+
+    if (kinds == TRUE) {
+        segs = allocMatrix (INTSXP, n, SGGC_N_KINDS);
+        SET_VECTOR_ELT (ans, 1, segs);
+        for (i = 0; i < n; i++) {
+            struct gc_record *r = &gc_history[(first+i) % GC_HISTORY_SIZE];
+            for (j = 0; j < SGGC_N_KINDS; j++)
+                INTEGER(segs)[i + (R_xlen_t)j*n] = r->kind_segments[j];
+        }
+        dn = allocVector (VECSXP, 2);
+        setAttrib (segs, R_DimNamesSymbol, dn);
+        SET_VECTOR_ELT (dn, 1, gc_kind_names());
+    }
+
+    UNPROTECT(1);
+    return ans;
+}
+
+/* .Internal(gc.hook(fun)) sets the function called after each garbage
+   collection (none if NULL), returning the previous one. */
+
+static SEXP do_gchook(SEXP call, SEXP op, SEXP args, SEXP rho)
+{
+    SEXP old = gc_hook;
+
+    checkArity(op, args);
+    if (CAR(args) != R_NilValue && !isFunction(CAR(args)))
+        error(_("'%s' must be a function or NULL"), "fun");
+    gc_hook = CAR(args);
+
+    return old;
 }
 
 static SEXP do_memlimits(SEXP call, SEXP op, SEXP args, SEXP env)
@@ -3619,6 +3957,8 @@ attribute_hidden FUNTAB R_FunTab_memory[] =
 {"gcinfo",	do_gcinfo,	0,	11,	1,	{PP_FUNCALL, PREC_FN,	0}},
 {"gc",		do_gc,		0,	11,	3,	{PP_FUNCALL, PREC_FN,	0}},
 {"gc.time",	do_gctime,	0,	1,	-1,	{PP_FUNCALL, PREC_FN,	0}},
+{"gc.history",	do_gchistory,	0,	11,	2,	{PP_FUNCALL, PREC_FN,	0}},
+{"gc.hook",	do_gchook,	0,	11,	1,	{PP_FUNCALL, PREC_FN,	0}},
 {"mem.limits",	do_memlimits,	0,	11,	2,	{PP_FUNCALL, PREC_FN,	0}},
 {"memory.profile",do_memoryprofile, 0,	11,	1,	{PP_FUNCALL, PREC_FN,	0}},
 {"pnamedcnt",	do_pnamedcnt,	0,	1,	-1,	{PP_FUNCALL, PREC_FN,	0}},
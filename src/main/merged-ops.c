@@ -60,21 +60,24 @@ extern double Rf_gamma_cody(double);
 #ifdef helpers_can_merge
 
 
-extern helpers_task_proc task_unary_minus, task_abs;
+extern helpers_task_proc task_unary_minus, task_abs, task_math1;
 
+extern double (* const R_math1_func_table[44])(double);
 
-/* CODES FOR MERGED ARITHMETIC OPERATIONS AND ABS FUNCTION. .
+
+/* CODES FOR MERGED ARITHMETIC OPERATIONS, ABS, AND MATH1 FUNCTIONS.
 
    Relies on PLUSOP ... DIVOP being the integers from 1 to 4. 
 
-   The opcode for the merged task procedure encodes two or more
-   operations plus a flag saying which is the vector operand.  The
-   flag is in the low-order byte.  The codes for the operations follow
-   in higher-order bytes, with the last operation in lowest position.
-   The code for the null operation is zero, so a null operation may
-   naturally occur in the higher-order byte, but this is manipulated
-   in task_merged_arith_abs so that it instead occurs only as the
-   middle operation.  
+   The opcode for the merged task procedure encodes two or more (up to
+   MAX_OPS_MERGED) operations plus a flag saying which is the vector
+   operand.  The flag is in the low-order byte.  The codes for the
+   operations follow in higher-order bytes, with the last operation in
+   lowest position.  The code for the null operation is zero, so null
+   operations occur in the higher-order bytes when fewer than the maximum
+   have been merged.  When there are only two, this is manipulated in
+   task_merged_arith_abs so that for the specialized procedures the null
+   operation instead occurs as the middle operation.
 
    For the PLUS and TIMES operations, which are commutative (except
    for NaN handling on Intel processors), only the C op V forms are
@@ -103,10 +106,18 @@ extern helpers_task_proc task_unary_minus, task_abs;
 #define N_MERGED_OPS_FIRST 10   /* Number of op codes for the first op,
                                    including NULL, which is not actually used */
 
+#define MERGED_OP_MATH1_BASE 16 /* Code for a math1 function is this plus its
+                                   opcode; only those that can't produce a
+                                   warning are merged, and these are done 
+                                   only with the general procedure below */
+
+#define MERGED_OP_MATH1(f)  (MERGED_OP_MATH1_BASE + (f))
 
-/* TASK FOR PERFORMING A SET OF MERGED ARITHMETIC OPERATIONS.
 
-   Works only when MAX_OPS_MERGED is 3.
+/* SPECIALIZED PROCEDURES FOR UP TO THREE MERGED ARITHMETIC OPERATIONS.
+
+   Used when no more than three operations have been merged, and none
+   of them is a math1 function.
 
    The code for the first operation (which is never MERGED_OP_NULL or
    a DIV operation) is used to select one of N_MERGED_OPS_FIRST-1
@@ -116,8 +127,8 @@ extern helpers_task_proc task_unary_minus, task_abs;
    compiler (in particular gcc) from using lots of time and memory
    processing a single large switch statement. */
 
-#if MAX_OPS_MERGED != 3
-#error Merged operations are implemented only when MAX_OPS_MERGED is 3
+#if MAX_OPS_MERGED < 3 || MAX_OPS_MERGED > 7
+#error Merged operations are implemented only when MAX_OPS_MERGED is 3 to 7
 #endif
 
 #define OP_NULL(k)       (void)0
@@ -311,17 +322,143 @@ static void (*proc_table[N_MERGED_OPS_FIRST])() = {
     proc_MERGED_OP_W_TIMES_V,
 };
 
+/* GENERAL PROCEDURE FOR ANY NUMBER OF MERGED OPERATIONS.
+
+   Used when more than three operations have been merged, or when one
+   of them is a math1 function.  The vector is processed in blocks of
+   MERGED_BLOCK elements, small enough to stay in the L1 cache.  The
+   first operation reads from the vector operand (and the other vector
+   for a W op) and stores into the block of the result, and later
+   operations are then applied in turn to this block of the result.
+   Each operation is a simple loop over the block, which the compiler
+   may vectorize.  No intermediate vectors are allocated, and the
+   operands and result are each passed over only once. */
+
+#define MERGED_BLOCK 256
+
+static void merged_block_op (int opc, int first, double c, double *dst, 
+                             double *src, double *w, R_len_t m)
+{
+    R_len_t j;
+
+    if (first) {
+        switch (opc) {
+        case MERGED_OP_W_PLUS_V:
+            for (j = 0; j < m; j++) dst[j] = w[j] + src[j];
+            return;
+        case MERGED_OP_W_MINUS_V:
+            for (j = 0; j < m; j++) dst[j] = w[j] - src[j];
+            return;
+        case MERGED_OP_W_TIMES_V:
+            for (j = 0; j < m; j++) dst[j] = w[j] * src[j];
+            return;
+        }
+    }
+
+    switch (opc) {
+    case MERGED_OP_C_PLUS_V:
+        for (j = 0; j < m; j++) dst[j] = c + src[j];
+        break;
+    case MERGED_OP_ABS_V:
+        for (j = 0; j < m; j++) dst[j] = fabs(src[j]);
+        break;
+    case MERGED_OP_C_MINUS_V:
+        for (j = 0; j < m; j++) dst[j] = c - src[j];
+        break;
+    case MERGED_OP_V_MINUS_C:
+        for (j = 0; j < m; j++) dst[j] = src[j] - c;
+        break;
+    case MERGED_OP_C_TIMES_V:
+        for (j = 0; j < m; j++) dst[j] = c * src[j];
+        break;
+    case MERGED_OP_V_SQUARED:
+        for (j = 0; j < m; j++) dst[j] = src[j] * src[j];
+        break;
+    case MERGED_OP_C_DIV_V:
+        for (j = 0; j < m; j++) dst[j] = c / src[j];
+        break;
+    case MERGED_OP_V_DIV_C:
+        for (j = 0; j < m; j++) dst[j] = src[j] / c;
+        break;
+    default: {
+        if (opc < MERGED_OP_MATH1_BASE) abort();
+        double (*f)(double) = R_math1_func_table[opc-MERGED_OP_MATH1_BASE];
+        for (j = 0; j < m; j++) {
+            double v = src[j];
+            dst[j] = ISNAN(v) ? v : f(v);
+        }
+        break;
+    }
+    }
+}
+
+static void merged_general (SEXP ans, double *vecp, double *w, int which,
+                            int nops, int *opc, double *c)
+{
+    double *ansp = REAL(ans);
+    R_len_t n = LENGTH(ans);
+    R_len_t i = 0;
+    R_len_t a;
+    int k;
+
+    while (i < n) {
+        if (which)
+            HELPERS_WAIT_IN2 (a, i, n);
+        else
+            HELPERS_WAIT_IN1 (a, i, n);
+        while (i < a) {
+            R_len_t m = a - i > MERGED_BLOCK ? MERGED_BLOCK : a - i;
+            merged_block_op (opc[0], 1, c[0], ansp+i, vecp+i, w+i, m);
+            for (k = 1; k < nops; k++)
+                merged_block_op (opc[k], 0, c[k], ansp+i, ansp+i, 0, m);
+            i += m;
+        }
+        helpers_amount_out(i);
+    }
+}
+
+
+/* TASK FOR PERFORMING A SET OF MERGED OPERATIONS.  Uses the specialized
+   procedures above when possible, and otherwise the general procedure. */
+
 void task_merged_arith_abs (helpers_op_t code, SEXP ans, SEXP s1, SEXP s2)
 {
     double *data = helpers_task_data();
-    double c1 = data[2], c2 = data[1], c3 = data[0]; \
     int which = code & 1;  /* which is the main vector operand? */
 
+    helpers_op_t ops = code >> 8;
+
+    /* Use the general procedure if there are more than three operations,
+       or any is a math1 function (the middle operation must also not be
+       a DIV, but that can't happen). */
+
+    if ((ops >> 24) != 0 || (ops & 0xff) >= MERGED_OP_MATH1_BASE
+         || ((ops >> 8) & 0xff) >= MERGED_OP_MATH1_BASE
+         || ((ops >> 16) & 0xff) >= MERGED_OP_MATH1_BASE) {
+
+        int opc[MAX_OPS_MERGED];
+        double c[MAX_OPS_MERGED];
+        int nops, k;
+
+        for (nops = 0; nops < MAX_OPS_MERGED && (ops >> 8*nops) != 0; nops++)
+            ;
+        for (k = 0; k < nops; k++) {
+            opc[k] = (ops >> 8*(nops-1-k)) & 0xff;
+            c[k] = data[nops-1-k];
+        }
+
+        double *w = which ? REAL(s1) : s2 != 0 ? REAL(s2) : 0;
+        merged_general (ans, which ? REAL(s2) : REAL(s1), w, which, 
+                        nops, opc, c);
+
+        return;
+    }
+
+    double c1 = data[2], c2 = data[1], c3 = data[0]; \
+
     /* Set up switch values encoding the first (possibly null) operation and
        the 2nd and 3rd operations. */
 
-    int ops = code >> 8;
-
     int switch1;
     int switch23;
 
@@ -351,11 +488,12 @@ void task_merged_arith_abs (helpers_op_t code, SEXP ans, SEXP s1, SEXP s2)
 }
 
 
-/* PROCEDURE FOR MERGING ARITHMETIC AND ABS OPERATIONS.  The scalar
-   operands for all merged operations are placed in the task_data block.
-   The vector operand for the merged operations may be either the first 
-   or second operand of the merged task procedure, with this being indicated 
-   by a flag in the operation code. */
+/* PROCEDURE FOR MERGING ARITHMETIC, ABS, AND MATH1 OPERATIONS.  The scalar
+   operands for all merged operations are placed in the task_data block,
+   with the operand for the last operation in task_data[0].  The vector 
+   operand for the merged operations may be either the first or second
+   operand of the merged task procedure, with this being indicated by a
+   flag in the operation code. */
 
 #define MERGED_BINARY_OP(proc,op,in1,in2) \
   ( op == POWOP    ? MERGED_OP_V_SQUARED : \
@@ -370,21 +508,27 @@ int helpers_merge_proc ( /* helpers_var_ptr out, */
 {
     helpers_op_t ops;
     int which;
+    int k;
    
     /* Set flags, which, and ops according to operations other than op_A. */
   
     if (*proc_B == task_merged_arith_abs) {
         which = *op_B & 1;
         ops = *op_B >> 8;
-        task_data[2] = task_data[1];
-        task_data[1] = task_data[0];
+        for (k = MAX_OPS_MERGED-1; k > 0; k--)
+            task_data[k] = task_data[k-1];
     }
     else { 
-        task_data[2] = task_data[1] = 0.0;
+        for (k = MAX_OPS_MERGED-1; k > 0; k--)
+            task_data[k] = 0.0;
         if (*proc_B == task_abs) {
             ops = MERGED_OP_ABS_V;
             which = 0;
         }
+        else if (*proc_B == task_math1) {
+            ops = MERGED_OP_MATH1 (*op_B & 0xff);
+            which = 0;
+        }
         else if (*proc_B == task_unary_minus) {
             ops = MERGED_OP_C_MINUS_V;
             task_data[1] = 0.0;
@@ -415,6 +559,10 @@ int helpers_merge_proc ( /* helpers_var_ptr out, */
     if (proc_A == task_abs) {
         newop = MERGED_OP_ABS_V;  
     }
+    else if (proc_A == task_math1) {
+        newop = MERGED_OP_MATH1 (op_A & 0xff);
+        task_data[0] = 0.0;
+    }
     else if (proc_A == task_unary_minus) {
         newop = MERGED_OP_C_MINUS_V;
         task_data[0] = 0.0;
@@ -435,9 +583,10 @@ int helpers_merge_proc ( /* helpers_var_ptr out, */
     *op_B = (ops << 8) | which;
 
     /* Return value to clear flags so no further merge allowed (and no hold)
-       if the maximum number of operations (three) have already been merged. */
+       if the maximum number of operations have already been merged. */
 
-    return (ops >> 16) ? (HELPERS_MERGE_OUT | HELPERS_HOLD) : 0;
+    return (ops >> 8*(MAX_OPS_MERGED-1)) ? (HELPERS_MERGE_OUT | HELPERS_HOLD) 
+                                         : 0;
 }
 
 #endif
@@ -865,7 +865,14 @@ static SEXP do_internal (SEXP call, SEXP op, SEXP args, SEXP env, int variant)
 
     R_Visible = TRUE;
 
-    ans = CALL_PRIMFUN(s, ifun, args, env, variant);
+    if (R_PrimCounting) {
+        R_prim_timing timing;
+        R_prim_count_begin (&timing);
+        ans = CALL_PRIMFUN(s, ifun, args, env, variant);
+        R_prim_count_end (&timing, ifun);
+    }
+    else
+        ans = CALL_PRIMFUN(s, ifun, args, env, variant);
 
     if (PRIMVISON(ifun))
         R_Visible = TRUE;
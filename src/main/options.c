@@ -54,6 +54,7 @@
    A (complete?!) list of these (2):
 
         "parse_dotdot"
+        "rng_streams"
   
   	"prompt"
   	"continue"
@@ -360,6 +361,11 @@ void attribute_hidden InitOptions(void)
     set_rl_word_breaks(" \t\n\"\\'`><=%;,|&{()}");
 #endif
 
+    SETCDR(v,CONS(R_NilValue,R_NilValue));
+    v = CDR(v);
+    SET_TAG(v, install("rng_streams"));
+    SETCAR(v, ScalarLogical(R_rng_streams));
+
     SETCDR(v,CONS(R_NilValue,R_NilValue));
     v = CDR(v);
     SET_TAG(v, install("helpers_disable"));
@@ -749,6 +755,15 @@ static SEXP do_options(SEXP call, SEXP op, SEXP args, SEXP rho)
 		val = duplicate(argi);
                 goto set;
 	    }
+	    if (streql(opname, "rng_streams")) {
+		if (TYPEOF(argi) != LGLSXP || LENGTH(argi) != 1
+                                           || *LOGICAL(argi) == NA_LOGICAL)
+		    error(_("invalid value for '%s'"), opname);
+		k = asLogical(argi);
+                R_rng_streams = k;
+		val = ScalarLogical(k);
+                goto set;
+	    }
             break;
             
             case 's':
@@ -130,36 +130,526 @@ static void __cdecl ProfileThread(void *pwait)
     }
 }
 #else /* not Win32 */
+
+/* On Unix-alikes, the SIGPROF handler does not write the sample itself,
+   but records it in a ring buffer, from which it is taken and written to
+   the output file by a separate thread.  The handler only reads R's data
+   structures (without allocating) and stores into the ring buffer, which
+   is updated without locking, since the handler is the only writer of
+   prof_head and the draining thread is the only writer of prof_tail.  If
+   the buffer is full, the sample is dropped (and counted).
+
+   A sample records, for each function (or builtin) context, the symbol
+   for the function (null if anonymous), the source line being executed in
+   that function (from R_Srcref for the innermost, and from the srcref saved
+   in the next context in for others), and whether the function is byte
+   compiled.  It also records whether the master was waiting for helpers to
+   finish tasks (eg, in wait_until_arguments_computed), and what task
+   procedures the master and the helpers were doing.  Since SIGPROF may be
+   delivered to a helper thread (whose CPU time it reflects), such signals
+   are forwarded to the master thread, where the context stack can safely
+   be looked at.
+
+   Symbols are never garbage collected, so their pointers can be saved for
+   the draining thread to get printnames from, but the names of source files
+   are copied to a table by the handler when first seen.
+
+   With the default text output format, the draining thread writes the
+   same lines as before.  The binary format written when Rprof is called
+   with binary=TRUE also has the other information, and is read by
+   summaryRprofBin.  It consists of the bytes "pqRprofB" followed by a
+   sequence of records made up of 32-bit little-endian integers.  The first
+   integer in each record gives the record's type, as follows:
+
+       0  header: version (1), sampling interval (microseconds), flags
+                  (PROF_MEMORY if memory profiling)
+       1  function name: id, number of bytes, the bytes (padded with zeros
+                  to a multiple of four)
+       2  source file name: id, number of bytes, the bytes (padded)
+       3  task procedure name: id, number of bytes, the bytes (padded)
+       4  sample: flags, number of frames, number of threads (master and
+                  helpers), an id for the task being done by each thread
+                  (0 if none), four memory use counts as doubles (eight
+                  integers) if PROF_MEMORY is in flags, and then, for each
+                  frame (innermost first), a function id (0 if anonymous),
+                  source file id (0 if unknown), line (0 if unknown), and
+                  frame flags
+       5  dropped samples: total number of samples dropped so far
+
+   Ids are positive integers, defined in a record before their first use.
+   If the file is appended to, a new "pqRprofB" and header will follow,
+   after which ids are defined anew. */
+
+#include <pthread.h>
+#include <errno.h>
+#include <helpers/helpers-app.h>
+
+#ifdef __GNUC__
+#define PROF_BARRIER() __sync_synchronize()
+#else
+#define PROF_BARRIER() do {} while (0)
+#endif
+
+#define PROF_RING_SIZE 128  /* Number of samples in ring buffer, power of 2 */
+#define PROF_MAX_DEPTH 512  /* Max number of frames recorded for a sample */
+#define PROF_MAX_FILES 256  /* Max number of source files recorded */
+#define PROF_FILE_LEN 256   /* Max length of source file name, plus one */
+
+#define PROF_WAITING 1      /* Flags for samples: master waiting for helpers */
+#define PROF_HELPER 2       /*   signal was received by a helper thread */
+#define PROF_TRUNCATED 4    /*   more than PROF_MAX_DEPTH frames */
+#define PROF_MEMORY 8       /*   memory use information is included */
+
+#define PROF_BYTECODE 1     /* Flag for frame: function is byte compiled */
+
+struct prof_frame {
+    SEXP fun;               /* Symbol for function, or NULL if anonymous */
+    int line;               /* Source line, or 0 if unknown */
+    short file;             /* Index of source file plus one, or 0 */
+    short flags;            /* Flags for frame */
+};
+
+struct prof_sample {
+    int flags;                                /* Flags for sample */
+    int depth;                                /* Number of frames */
+    int ntasks;                               /* Number of entries in tasks */
+    helpers_task_proc *tasks[HELPERS_MAX+1];  /* Task procedure being done by
+                                                 master and each helper */
+    unsigned long mem[4];                     /* Memory use information */
+    struct prof_frame frame[PROF_MAX_DEPTH];  /* Frames, innermost first */
+};
+
+static struct prof_sample *prof_ring;  /* Ring buffer of samples */
+static volatile unsigned prof_head;    /* Index of next to store (mod size) */
+static volatile unsigned prof_tail;    /* Index of next to write (mod size) */
+static volatile unsigned prof_dropped; /* Number of samples dropped */
+static volatile int prof_forwarded;    /* Signal was forwarded from helper */
+static volatile int prof_stop;         /* Tells draining thread to finish */
+
+static char prof_file_name[PROF_MAX_FILES][PROF_FILE_LEN];
+static volatile int prof_nfiles;       /* Number of source files in table */
+
+static int R_Prof_Binary;              /* Write binary format? */
+static int prof_thread_running;        /* Is draining thread running? */
+static pthread_t prof_master;          /* The master thread */
+static pthread_t prof_thread;          /* The draining thread */
+static SEXP prof_filename_symbol;      /* Symbol "filename" */
+static int prof_filename_hash;         /* Hash code for prof_filename_symbol */
+
+/* Find the "filename" binding in a srcfile environment, returning its
+   value, or R_NilValue if there isn't one.  Called from the signal
+   handler, so it must not allocate, evaluate, or update the lookup
+   caches kept in symbols (as findVarInFrame3 does); it just follows
+   the frame or hash chain, ignoring active bindings.  The symbol and
+   its hash code are found when Rprof starts. */
+
+static SEXP prof_filename_value (SEXP srcfile)
+{
+    SEXP loc;
+
+    if (HASHTAB(srcfile) != R_NilValue)
+        loc = VECTOR_ELT (HASHTAB(srcfile),
+                          prof_filename_hash % HASHLEN(srcfile));
+    else
+        loc = FRAME(srcfile);
+
+    for ( ; loc != R_NilValue; loc = CDR(loc)) {
+        if (TAG(loc) == prof_filename_symbol)
+            return IS_ACTIVE_BINDING(loc) ? R_NilValue : CAR(loc);
+    }
+
+    return R_NilValue;
+}
+
+/* Find the index (plus one) in the table of source files of the file for
+   a srcref, adding it if it isn't there.  Returns 0 if it isn't known. */
+
+static int prof_file (SEXP srcref)
+{
+    SEXP a, srcfile, name;
+    const char *c;
+    int i;
+
+    srcfile = R_NilValue;
+    for (a = ATTRIB(srcref); a != R_NilValue; a = CDR(a)) {
+        if (TAG(a) == R_SrcfileSymbol) {
+            srcfile = CAR(a);
+            break;
+        }
+    }
+    if (TYPEOF(srcfile) != ENVSXP)
+        return 0;
+
+    name = prof_filename_value (srcfile);
+    if (TYPEOF(name) != STRSXP || LENGTH(name) < 1)
+        return 0;
+    c = CHAR (STRING_ELT (name, 0));
+
+    for (i = 0; i < prof_nfiles; i++) {
+        if (strncmp (prof_file_name[i], c, PROF_FILE_LEN-1) == 0)
+            return i+1;
+    }
+    if (i == PROF_MAX_FILES)
+        return 0;
+
+    strncpy (prof_file_name[i], c, PROF_FILE_LEN-1);
+    prof_nfiles = i+1;
+
+    return i+1;
+}
+
 static void doprof(int sig)
 {
+    int saved_errno = errno;
+    struct prof_sample *smp;
     RCNTXT *cptr;
-    int newline = 0;
-    unsigned long bigv, smallv, nodes;
-    if (R_Mem_Profiling){
-	    get_current_mem(&smallv, &bigv, &nodes);
-	    if (!newline) newline = 1;
-	    fprintf(R_ProfileOutfile, ":%ld:%ld:%ld:%ld:", smallv, bigv,
-		     nodes, get_duplicate_counter());
-	    reset_duplicate_counter();
+    SEXP srcref;
+    unsigned head;
+    int d;
+
+    if (!pthread_equal (pthread_self(), prof_master)) {
+        prof_forwarded = 1;
+        pthread_kill (prof_master, SIGPROF);
+        errno = saved_errno;
+        return;
+    }
+
+    head = prof_head;
+    if (head - prof_tail >= PROF_RING_SIZE) {
+        prof_dropped += 1;
+        goto done;
+    }
+    smp = prof_ring + (head & (PROF_RING_SIZE-1));
+
+    smp->flags = 0;
+    if (prof_forwarded) {
+        smp->flags |= PROF_HELPER;
+        prof_forwarded = 0;
+    }
+    if (helpers_master_waiting)
+        smp->flags |= PROF_WAITING;
+    smp->ntasks = helpers_running (smp->tasks);
+
+    if (R_Mem_Profiling) {
+        get_current_mem (&smp->mem[0], &smp->mem[1], &smp->mem[2]);
+        smp->mem[3] = get_duplicate_counter();
+        reset_duplicate_counter();
+        smp->flags |= PROF_MEMORY;
     }
+
+    d = 0;
+    srcref = R_Srcref;
     for (cptr = R_GlobalContext; cptr; cptr = cptr->nextcontext) {
 	if ((cptr->callflag & (CTXT_FUNCTION | CTXT_BUILTIN))
 	    && TYPEOF(cptr->call) == LANGSXP) {
 	    SEXP fun = CAR(cptr->call);
-	    if (!newline) newline = 1;
-	    fprintf(R_ProfileOutfile, "\"%s\" ",
-		    TYPEOF(fun) == SYMSXP ? CHAR(PRINTNAME(fun)) :
-		    "<Anonymous>");
-	}
+            struct prof_frame *f;
+            if (d == PROF_MAX_DEPTH) {
+                smp->flags |= PROF_TRUNCATED;
+                break;
+            }
+            f = smp->frame + d;
+            f->fun = TYPEOF(fun) == SYMSXP ? fun : NULL;
+            if (srcref != NULL && TYPEOF(srcref) == INTSXP
+                                && LENGTH(srcref) >= 4) {
+                f->line = INTEGER(srcref)[0];
+                f->file = prof_file (srcref);
+            }
+            else {
+                f->line = 0;
+                f->file = 0;
+            }
+            f->flags = (cptr->callflag & CTXT_FUNCTION)
+                        && TYPEOF(cptr->callfun) == CLOSXP
+                        && TYPEOF(BODY(cptr->callfun)) == BCODESXP
+                         ? PROF_BYTECODE : 0;
+            srcref = cptr->srcref;
+            d += 1;
+        }
     }
-    if (newline) fprintf(R_ProfileOutfile, "\n");
+    smp->depth = d;
+
+    PROF_BARRIER();  /* sample must be stored before head is updated */
+    prof_head = head + 1;
+
+  done:
     signal(SIGPROF, doprof);
+    errno = saved_errno;
 }
 
 static void doprof_null(int sig)
 {
     signal(SIGPROF, doprof_null);
 }
+
+/* Procedures used in the draining thread to write samples.  The tables of
+   ids for functions and task procedures are used only in this thread. */
+
+static SEXP *prof_fun_hash;        /* Hash table of function symbols */
+static int *prof_fun_id;           /* Ids for symbols in prof_fun_hash */
+static unsigned prof_fun_size;     /* Size of hash table, a power of 2 */
+static int prof_nfuns;             /* Number of function ids defined */
+
+static helpers_task_proc *prof_task_procs[256]; /* Procs, index is id-1 */
+static int prof_ntasks;            /* Number of task ids defined */
+
+static int prof_files_written;     /* Number of source file ids defined */
+static unsigned prof_dropped_written; /* Dropped count last written */
+
+static void prof_write_int (int v)
+{
+    unsigned char b[4];
+    b[0] = v & 0xff;
+    b[1] = (v >> 8) & 0xff;
+    b[2] = (v >> 16) & 0xff;
+    b[3] = (v >> 24) & 0xff;
+    fwrite (b, 1, 4, R_ProfileOutfile);
+}
+
+static void prof_write_double (double v)
+{
+    union { double d; uint64_t u; } x;
+    x.d = v;
+    prof_write_int ((int) (x.u & 0xffffffff));
+    prof_write_int ((int) (x.u >> 32));
+}
+
+static void prof_write_name (int type, int id, const char *name)
+{
+    static const char zeros[4] = { 0, 0, 0, 0 };
+    int n = strlen(name);
+
+    prof_write_int (type);
+    prof_write_int (id);
+    prof_write_int (n);
+    fwrite (name, 1, n, R_ProfileOutfile);
+    fwrite (zeros, 1, (4 - (n & 3)) & 3, R_ProfileOutfile);
+}
+
+static void prof_write_header (int interval)
+{
+    fwrite ("pqRprofB", 1, 8, R_ProfileOutfile);
+    prof_write_int (0);
+    prof_write_int (1);
+    prof_write_int (interval);
+    prof_write_int (R_Mem_Profiling ? PROF_MEMORY : 0);
+}
+
+/* Find the id for a function symbol, writing a record defining it if it is
+   new.  Returns 0 for an anonymous function. */
+
+static int prof_fun (SEXP fun)
+{
+    unsigned h;
+
+    if (fun == NULL)
+        return 0;
+
+    if (2 * (prof_nfuns + 1) > prof_fun_size) {
+        unsigned old_size = prof_fun_size;
+        SEXP *old_hash = prof_fun_hash;
+        int *old_id = prof_fun_id;
+        unsigned i;
+        prof_fun_size = old_size == 0 ? 1024 : 2 * old_size;
+        prof_fun_hash = calloc (prof_fun_size, sizeof *prof_fun_hash);
+        prof_fun_id = calloc (prof_fun_size, sizeof *prof_fun_id);
+        if (prof_fun_hash == NULL || prof_fun_id == NULL)
+            R_Suicide("unable to allocate space for profiling");
+        for (i = 0; i < old_size; i++) {
+            if (old_hash[i] != NULL) {
+                h = ((uintptr_t) old_hash[i] >> 4) & (prof_fun_size-1);
+                while (prof_fun_hash[h] != NULL)
+                    h = (h + 1) & (prof_fun_size-1);
+                prof_fun_hash[h] = old_hash[i];
+                prof_fun_id[h] = old_id[i];
+            }
+        }
+        free (old_hash);
+        free (old_id);
+    }
+
+    h = ((uintptr_t) fun >> 4) & (prof_fun_size-1);
+    while (prof_fun_hash[h] != NULL) {
+        if (prof_fun_hash[h] == fun)
+            return prof_fun_id[h];
+        h = (h + 1) & (prof_fun_size-1);
+    }
+
+    prof_fun_hash[h] = fun;
+    prof_fun_id[h] = ++prof_nfuns;
+    prof_write_name (1, prof_nfuns, CHAR(PRINTNAME(fun)));
+
+    return prof_nfuns;
+}
+
+/* Find the id for a task procedure, writing a record defining it if it is
+   new.  Returns 0 for no task, or if there are too many to record. */
+
+static int prof_task (helpers_task_proc *proc)
+{
+    int i;
+
+    if (proc == NULL)
+        return 0;
+
+    for (i = 0; i < prof_ntasks; i++) {
+        if (prof_task_procs[i] == proc)
+            return i+1;
+    }
+    if (i == 256)
+        return 0;
+
+    prof_task_procs[i] = proc;
+    prof_ntasks = i+1;
+    prof_write_name (3, prof_ntasks, helpers_task_name(proc));
+
+    return prof_ntasks;
+}
+
+static void prof_write_sample (struct prof_sample *smp)
+{
+    int i;
+
+    if (!R_Prof_Binary) {
+        int newline = 0;
+        if (smp->flags & PROF_MEMORY) {
+            newline = 1;
+	    fprintf(R_ProfileOutfile, ":%ld:%ld:%ld:%ld:", smp->mem[0],
+                    smp->mem[1], smp->mem[2], smp->mem[3]);
+        }
+        for (i = 0; i < smp->depth; i++) {
+            SEXP fun = smp->frame[i].fun;
+            newline = 1;
+	    fprintf(R_ProfileOutfile, "\"%s\" ",
+		    fun != NULL ? CHAR(PRINTNAME(fun)) : "<Anonymous>");
+        }
+        if (newline) fprintf(R_ProfileOutfile, "\n");
+        return;
+    }
+
+    int nfiles = prof_nfiles;
+    int task_id[HELPERS_MAX+1];
+    int fun_id[PROF_MAX_DEPTH];
+
+    while (prof_files_written < nfiles) {
+        prof_write_name (2, prof_files_written+1,
+                         prof_file_name[prof_files_written]);
+        prof_files_written += 1;
+    }
+    for (i = 0; i < smp->ntasks; i++)
+        task_id[i] = prof_task (smp->tasks[i]);
+    for (i = 0; i < smp->depth; i++)
+        fun_id[i] = prof_fun (smp->frame[i].fun);
+
+    prof_write_int (4);
+    prof_write_int (smp->flags);
+    prof_write_int (smp->depth);
+    prof_write_int (smp->ntasks);
+    for (i = 0; i < smp->ntasks; i++)
+        prof_write_int (task_id[i]);
+    if (smp->flags & PROF_MEMORY) {
+        for (i = 0; i < 4; i++)
+            prof_write_double ((double) smp->mem[i]);
+    }
+    for (i = 0; i < smp->depth; i++) {
+        prof_write_int (fun_id[i]);
+        prof_write_int (smp->frame[i].file);
+        prof_write_int (smp->frame[i].line);
+        prof_write_int (smp->frame[i].flags);
+    }
+}
+
+static void prof_write_dropped (void)
+{
+    unsigned dropped = prof_dropped;
+
+    if (R_Prof_Binary && dropped != prof_dropped_written) {
+        prof_write_int (5);
+        prof_write_int ((int) dropped);
+        prof_dropped_written = dropped;
+    }
+}
+
+/* Procedure run in the draining thread.  Checks for new samples every 10ms,
+   or at a shorter interval if profiling samples are taken more often. */
+
+static void *prof_drain (void *arg)
+{
+    int interval = * (int *) arg;
+    struct timespec ts;
+
+    ts.tv_sec = 0;
+    ts.tv_nsec = 1000L * (interval < 10000 ? interval : 10000);
+
+    for (;;) {
+        int stop = prof_stop;
+        PROF_BARRIER();
+        while (prof_tail != prof_head) {
+            PROF_BARRIER();  /* sample must be read after head is */
+            prof_write_sample (prof_ring + (prof_tail & (PROF_RING_SIZE-1)));
+            PROF_BARRIER();  /* and be finished with before tail changes */
+            prof_tail = prof_tail + 1;
+        }
+        prof_write_dropped();
+        if (stop)
+            break;
+        nanosleep (&ts, NULL);
+    }
+
+    return NULL;
+}
+
+/* Start the draining thread, with SIGPROF blocked in it. */
+
+static void prof_start_thread (int interval)
+{
+    static int thread_interval;
+    sigset_t set, old;
+
+    prof_ring = malloc (PROF_RING_SIZE * sizeof *prof_ring);
+    if (prof_ring == NULL)
+	R_Suicide("unable to allocate space for profiling");
+
+    prof_head = prof_tail = 0;
+    prof_dropped = prof_dropped_written = 0;
+    prof_forwarded = 0;
+    prof_stop = 0;
+    prof_nfiles = prof_files_written = 0;
+    prof_nfuns = 0;
+    prof_ntasks = 0;
+    if (prof_fun_size != 0)
+        memset (prof_fun_hash, 0, prof_fun_size * sizeof *prof_fun_hash);
+    prof_filename_symbol = install("filename");
+    prof_filename_hash = SYM_HASH(prof_filename_symbol);
+    prof_master = pthread_self();
+    thread_interval = interval;
+
+    sigemptyset (&set);
+    sigaddset (&set, SIGPROF);
+    pthread_sigmask (SIG_BLOCK, &set, &old);
+    if (pthread_create (&prof_thread, NULL, prof_drain, &thread_interval) != 0)
+	R_Suicide("unable to create profiling thread");
+    pthread_sigmask (SIG_SETMASK, &old, NULL);
+
+    prof_thread_running = 1;
+}
+
+/* Stop the draining thread, after it writes all samples. */
+
+static void prof_stop_thread (void)
+{
+    if (!prof_thread_running)
+        return;
+
+    PROF_BARRIER();
+    prof_stop = 1;
+    pthread_join (prof_thread, NULL);
+    prof_thread_running = 0;
+
+    free (prof_ring);
+    prof_ring = NULL;
+}
+
 #endif /* not Win32 */
 
 
@@ -177,13 +667,15 @@ static void R_EndProfiling(void)
     itv.it_value.tv_usec = 0;
     setitimer(ITIMER_PROF, &itv, NULL);
     signal(SIGPROF, doprof_null);
+    prof_stop_thread();
 #endif /* not Win32 */
     if(R_ProfileOutfile) fclose(R_ProfileOutfile);
     R_ProfileOutfile = NULL;
     R_Profiling = 0;
 }
 
-static void R_InitProfiling(SEXP filename, int append, double dinterval, int mem_profiling)
+static void R_InitProfiling(SEXP filename, int append, double dinterval, 
+                            int mem_profiling, int binary)
 {
 #ifndef Win32
     struct itimerval itv;
@@ -195,16 +687,27 @@ static void R_InitProfiling(SEXP filename, int append, double dinterval, int mem
 
     interval = 1e6 * dinterval + 0.5;
     if(R_ProfileOutfile != NULL) R_EndProfiling();
-    R_ProfileOutfile = RC_fopen(filename, append ? "a" : "w", TRUE);
+#ifdef Win32
+    if (binary)
+	error(_("Rprof: binary output is not supported on this platform"));
+#endif
+    R_ProfileOutfile = RC_fopen(filename, append ? (binary ? "ab" : "a")
+                                                 : (binary ? "wb" : "w"), TRUE);
     if (R_ProfileOutfile == NULL)
 	error(_("Rprof: cannot open profile file '%s'"),
 	      translateChar(filename));
+    R_Mem_Profiling=mem_profiling;
+#ifndef Win32
+    R_Prof_Binary = binary;
+    if (binary)
+        prof_write_header(interval);
+    else
+#endif
     if(mem_profiling)
 	fprintf(R_ProfileOutfile, "memory profiling: sample.interval=%d\n", interval);
     else
 	fprintf(R_ProfileOutfile, "sample.interval=%d\n", interval);
 
-    R_Mem_Profiling=mem_profiling;
     if (mem_profiling)
 	reset_duplicate_counter();
 
@@ -218,6 +721,7 @@ static void R_InitProfiling(SEXP filename, int append, double dinterval, int mem
 	R_Suicide("unable to create profiling thread");
     Sleep(wait/2); /* suspend this thread to ensure that the other one starts */
 #else /* not Win32 */
+    prof_start_thread(interval);
     signal(SIGPROF, doprof);
 
     itv.it_interval.tv_sec = 0;
@@ -233,7 +737,7 @@ static void R_InitProfiling(SEXP filename, int append, double dinterval, int mem
 static SEXP do_Rprof(SEXP call, SEXP op, SEXP args, SEXP rho)
 {
     SEXP filename;
-    int append_mode, mem_profiling;
+    int append_mode, mem_profiling, binary;
     double dinterval;
 
     checkArity(op, args);
@@ -242,9 +746,11 @@ static SEXP do_Rprof(SEXP call, SEXP op, SEXP args, SEXP rho)
     append_mode = asLogical(CADR(args));
     dinterval = asReal(CADDR(args));
     mem_profiling = asLogical(CADDDR(args));
+    binary = asLogical(CAD4R(args));
     filename = STRING_ELT(CAR(args), 0);
     if (LENGTH(filename))
-	R_InitProfiling(filename, append_mode, dinterval, mem_profiling);
+	R_InitProfiling(filename, append_mode, dinterval, mem_profiling,
+                        binary == TRUE);
     else
 	R_EndProfiling();
     return R_NilValue;
@@ -263,7 +769,7 @@ attribute_hidden FUNTAB R_FunTab_profile[] =
 {
 /* printname	c-entry		offset	eval	arity	pp-kind	     precedence	rightassoc */
 
-{"Rprof",	do_Rprof,	0,	11,	4,	{PP_FUNCALL, PREC_FN,	0}},
+{"Rprof",	do_Rprof,	0,	11,	5,	{PP_FUNCALL, PREC_FN,	0}},
 
 {NULL,		NULL,		0,	0,	0,	{PP_INVALID, PREC_FN,	0}},
 };
@@ -36,6 +36,8 @@
 #include <Rmath.h>		/* for rxxx functions */
 #include <errno.h>
 
+#include <helpers/helpers-app.h>
+
 R_NORETURN static void invalid(SEXP call)
 {
     error(_("invalid arguments"));
@@ -133,6 +135,155 @@ static SEXP do_random1(SEXP call, SEXP op, SEXP args, SEXP rho)
 }
 
 
+/* Generation of large vectors of normal or uniform random values in blocks,
+   from separate streams, when the rng_streams option is TRUE, the generator
+   is L'Ecuyer-CMRG, and (for normals) the normal kind is Inversion.  Block
+   b is generated from the b'th substream after the current seed, and the
+   seed is afterwards set to the next substream after those used.  The 
+   blocks may be generated in helper threads, but since the block size is
+   fixed, the results don't depend on the number of threads.  The first
+   block contains the same values as would be generated without the 
+   rng_streams option. */
+
+extern Rboolean Rf_RNG_stream_seed (Int32 *, int);    /* in RNG.c */
+extern void Rf_RNG_set_stream_seed (const Int32 *);
+extern void Rf_RNG_next_substream (Int32 *);
+extern void Rf_RNG_stream_unif (Int32 *, double *, int);
+
+#define RNG_STREAM_BLOCK 65536  /* Number of values generated per stream */
+#define RNG_STREAM_CHUNK 128    /* Number of values transformed at once */
+
+struct rng_streams_info {
+    int norm;                   /* Generate normals? (else uniforms) */
+    int nblocks;                /* Number of blocks */
+    double a, b;                /* Parameters (mean & sd, or min & max) */
+                                /* Followed by seeds, 6 for each block */
+};
+
+/* Generate len values from the stream with state seed[0..5], storing them
+   in x.  Uniforms are generated a chunk at a time and then transformed, 
+   in the same way as by rnorm (with Inversion) or runif.  Note that the
+   L'Ecuyer-CMRG generator never produces 0 or 1, so runif never needs to
+   generate another uniform. */
+
+static void rng_stream_block (struct rng_streams_info *info, Int32 *seed,
+                              double *x, int len)
+{
+#   define BIG 134217728 /* 2^27, as in norm_rand */
+
+    double u[2*RNG_STREAM_CHUNK];
+    double a = info->a, b = info->b;
+    int i, k;
+
+    while (len > 0) {
+        k = len < RNG_STREAM_CHUNK ? len : RNG_STREAM_CHUNK;
+        if (info->norm) {
+            Rf_RNG_stream_unif (seed, u, 2*k);
+            for (i = 0; i < k; i++) {
+                double v = (int)(BIG*u[2*i]) + u[2*i+1];
+                x[i] = a + b * qnorm5 (v/BIG, 0.0, 1.0, 1, 0);
+            }
+        }
+        else {
+            Rf_RNG_stream_unif (seed, u, k);
+            for (i = 0; i < k; i++)
+                x[i] = a + (b - a) * u[i];
+        }
+        x += k;
+        len -= k;
+    }
+}
+
+/* Task procedure for generating blocks of values in x, with ws a raw
+   vector containing a struct rng_streams_info followed by the seeds.
+   The blocks may be split amongst s tasks, with w (from 0) and s-1 
+   given in op (as for task_mvfft).  Tasks other than the first wait for
+   earlier tasks before finishing, so that x is computed when the last 
+   task finishes. */
+
+void task_rng_streams (helpers_op_t op, SEXP x, SEXP ws, SEXP unused)
+{
+    int w = op >> 40;
+    int s = 1 + ((op >> 32) & 0xff);
+
+    struct rng_streams_info *info = (struct rng_streams_info *) RAW(ws);
+    Int32 *seeds = (Int32 *) (info + 1);
+    int n = LENGTH(x);
+    int nb = info->nblocks;
+    int b0 = (int) ((double) nb * w / s);
+    int b1 = (int) ((double) nb * (w+1) / s);
+
+    for (int b = b0; b < b1; b++) {
+        Int32 seed[6];
+        int start = b * RNG_STREAM_BLOCK;
+        int len = n - start < RNG_STREAM_BLOCK ? n - start : RNG_STREAM_BLOCK;
+        memcpy (seed, seeds + 6*b, sizeof seed);
+        rng_stream_block (info, seed, REAL(x) + start, len);
+    }
+
+    if (w != 0) {
+        while (helpers_avail0(LENGTH(x)) < LENGTH(x)) ;
+    }
+}
+
+/* Fill x with normal (norm TRUE) or uniform random values using separate
+   streams, if possible.  Returns TRUE if this was done, FALSE if the
+   values must be generated in the usual way (which will then produce
+   NaN values, or values that don't use the generator, if the parameters
+   are such that that is what rnorm or runif would do).  GetRNGstate must
+   be called before, and PutRNGstate after. */
+
+static Rboolean rng_streams_fill (int norm, SEXP x, double a, double b)
+{
+    int n = LENGTH(x);
+    Int32 seed[6];
+
+    if (norm ? !R_FINITE(a) || !R_FINITE(b) || b <= 0
+             : !R_FINITE(a) || !R_FINITE(b) || b <= a)
+        return FALSE;
+
+    if (!Rf_RNG_stream_seed (seed, norm))
+        return FALSE;
+
+    int nb = (n - 1) / RNG_STREAM_BLOCK + 1;
+    SEXP ws = allocVector (RAWSXP, sizeof (struct rng_streams_info)
+                                    + (size_t) nb * 6 * sizeof (Int32));
+    struct rng_streams_info *info = (struct rng_streams_info *) RAW(ws);
+    Int32 *seeds = (Int32 *) (info + 1);
+
+    info->norm = norm;
+    info->nblocks = nb;
+    info->a = a;
+    info->b = b;
+
+    for (int i = 0; i < nb; i++) {
+        memcpy (seeds + 6*i, seed, sizeof seed);
+        Rf_RNG_next_substream (seed);
+    }
+    Rf_RNG_set_stream_seed (seed);
+
+    int s = helpers_not_multithreading_now ? 1 : helpers_num + 1;
+    if (s > nb) s = nb;
+
+    if (s <= 1)
+        task_rng_streams (0, x, ws, (helpers_var_ptr)0);
+    else {
+        PROTECT(ws);
+        for (int w = 0; w < s; w++)
+            helpers_do_task (w == 0   ? HELPERS_PIPE_OUT :
+                             w < s-1  ? HELPERS_PIPE_IN0_OUT 
+                                      : HELPERS_PIPE_IN0,
+                             task_rng_streams,
+                             ((helpers_op_t)w<<40) | ((helpers_op_t)(s-1)<<32),
+                             x, ws, (helpers_var_ptr)0);
+        WAIT_UNTIL_COMPUTED(x);
+        UNPROTECT(1);
+    }
+
+    return TRUE;
+}
+
+
 /* Random sampling from 2-parameter families. */
 
 static double (*rand2_funs[14])(double,double) = {
@@ -202,6 +353,14 @@ static SEXP do_random2(SEXP call, SEXP op, SEXP args, SEXP rho)
 
     GetRNGstate();
 
+    if (R_rng_streams && n > RNG_STREAM_BLOCK && na1 == 1 && na2 == 1
+          && (rf == rnorm || rf == runif)
+          && rng_streams_fill (rf == rnorm, x, *REAL(a1), *REAL(a2))) {
+        PutRNGstate();
+        UNPROTECT(3); /* a1, a2, x */
+        return x;
+    }
+
     double *ap1 = REAL(a1), *ap2 = REAL(a2), *xp = REAL(x);
 
     if (na1 == 1 && na2 == 1) {
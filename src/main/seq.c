@@ -99,10 +99,23 @@ static SEXP cross_colon(SEXP call, SEXP s, SEXP t)
     return(a);
 }
 
-/* Create a simple integer sequence, or as variant, a description of it. 
-   Sets R_variant_result to 1 if a sequence description is returned in
-   R_variant_seq_spec (with R_NilValue being the returned SEXP).  Won't
-   put all zeros in R_variant_seq_spec.
+/* Find the sum of the integer sequence from, from+step, ..., with len
+   elements (step being 1 or -1), for a VARIANT_SUM result, or return 
+   R_NoObject if the sum is not representable as an integer (in which case
+   the sequence should be created, so that sum will give the usual warning). */
+
+static SEXP seq_sum (int from, int len, int step)
+{
+    int64_t s = (int64_t) len * from 
+                  + step * ((int64_t) len * (len-1) / 2);
+
+    return s > INT_MAX || s <= INT_MIN ? R_NoObject : ScalarInteger ((int) s);
+}
+
+/* Create a simple integer sequence, or as variant, a description of it
+   or its sum.  Sets R_variant_result to 1 if a sequence description is 
+   returned in R_variant_seq_spec (with R_NilValue being the returned SEXP).
+   Won't put all zeros in R_variant_seq_spec.
 
    If dotdot is true, attaches 1D dim attribute (or spec says to do so). */
 
@@ -110,6 +123,12 @@ static SEXP make_seq (int from, int len, int variant, int dotdot)
 {
     SEXP ans;
 
+    if (VARIANT_KIND(variant) == VARIANT_SUM) {
+        ans = seq_sum (from, len, 1);
+        if (ans != R_NoObject)
+            return ans;
+    }
+
     if (VARIANT_KIND(variant) == VARIANT_SEQ && (from|len|dotdot) != 0) {
         R_variant_seq_spec = 
           ((int64_t)from * ((int64_t)1<<32)) /* Note: -ve<<. is undef in C99 */
@@ -165,6 +184,11 @@ static SEXP seq_colon(double n1, double n2, int dotdot, SEXP call, int variant)
         if (dotdot || n1 <= n2)
             ans = make_seq (in1, n, variant, dotdot);
         else {
+            if (VARIANT_KIND(variant) == VARIANT_SUM) {
+                ans = seq_sum (in1, n, -1);
+                if (ans != R_NoObject)
+                    return ans;
+            }
 	    ans = allocVector(INTSXP, n);
             for (i = 0; i < n; i++) INTEGER(ans)[i] = in1 - i;
         }
@@ -324,6 +324,14 @@ static attribute_noinline void decode_doubles (double *d, int n, void *buf)
 #define CHUNK_SIZE 1024
 #define CBUF_SIZE (CHUNK_SIZE * sizeof (Rcomplex))  /* Rcomplex is biggest */
 
+/* Vectors in native binary format, and raw vectors in either binary
+   format, are written and read directly from their data, in chunks that
+   are as large as possible while keeping the number of bytes within an
+   int, so that a stream that writes to a file or socket needs only one
+   system call for most vectors. */
+
+#define BINARY_CHUNK_SIZE ((int) (INT_MAX / sizeof (Rcomplex)))
+
 
 /* BASIC OUTPUT ROUTINES. */
 
@@ -957,10 +965,9 @@ static attribute_noinline void OutIntegerVec (struct outpar *par, SEXP s)
     }
     case R_pstream_binary_format:
     {
-	/* write in chunks to avoid overflowing ints */
 	int done, this;
 	for (done = 0; done < length; done += this) {
-	    this = min2(CHUNK_SIZE, length - done);
+	    this = min2(BINARY_CHUNK_SIZE, length - done);
 	    stream->OutBytes(stream, INTEGER(s) + done, sizeof(int) * this);
 	}
 	break;
@@ -994,7 +1001,7 @@ static attribute_noinline void OutRealVec (struct outpar *par, SEXP s)
     {
 	int done, this;
         for (done = 0; done < length; done += this) {
-	    this = min2(CHUNK_SIZE, length - done);
+	    this = min2(BINARY_CHUNK_SIZE, length - done);
 	    stream->OutBytes(stream, REAL(s) + done, sizeof(double) * this);
 	}
 	break;
@@ -1028,7 +1035,7 @@ static attribute_noinline void OutComplexVec (struct outpar *par, SEXP s)
     {
 	int done, this;
         for (done = 0; done < length; done += this) {
-	    this = min2(CHUNK_SIZE, length - done);
+	    this = min2(BINARY_CHUNK_SIZE, length - done);
 	    stream->OutBytes(stream, COMPLEX(s) + done, 
 			     sizeof(Rcomplex) * this);
 	}
@@ -1215,7 +1222,7 @@ static void WriteItem (struct outpar *par, SEXP s)
         case R_pstream_binary_format: {
             int done, this, len = LENGTH(s);
             for (done = 0; done < len; done += this) {
-                this = min2(CHUNK_SIZE, len - done);
+                this = min2(BINARY_CHUNK_SIZE, len - done);
                 stream->OutBytes(stream, RAW(s) + done, this);
             }
             break;
@@ -1391,31 +1398,38 @@ static void WriteBC (struct outpar *par, SEXP s)
     UNPROTECT(1);
 }
 
-/* R_Serialize is accessible from outside.  R_Serialize_internal has the
-   additional nosharing argument for use in this module. */
+/* Write the format and version information that precedes the object. */
 
-static void R_Serialize_internal (SEXP s, R_outpstream_t stream, int nosharing)
+static void WriteHeader (struct outpar *par)
 {
-    struct outpar par;
-    char buf [CBUF_SIZE];
-    par.nosharing = nosharing;
-    par.stream = stream;
-    par.buf = buf;
-    PROTECT(par.ref_table = MakeHashTable());
-
+    R_outpstream_t stream = par->stream;
     int version = stream->version;
 
     OutFormat(stream);
 
     switch(version) {
     case 2:
-	OutInteger(&par, version);
-	OutInteger(&par, R_VERSION);
-	OutInteger(&par, R_Version(2,3,0));
+	OutInteger(par, version);
+	OutInteger(par, R_VERSION);
+	OutInteger(par, R_Version(2,3,0));
 	break;
     default: error(_("version %d not supported"), version);
     }
+}
+
+/* R_Serialize is accessible from outside.  R_Serialize_internal has the
+   additional nosharing argument for use in this module. */
 
+static void R_Serialize_internal (SEXP s, R_outpstream_t stream, int nosharing)
+{
+    struct outpar par;
+    char buf [CBUF_SIZE];
+    par.nosharing = nosharing;
+    par.stream = stream;
+    par.buf = buf;
+    PROTECT(par.ref_table = MakeHashTable());
+
+    WriteHeader (&par);
     WriteItem (&par, s);
 
     UNPROTECT(1);
@@ -1542,7 +1556,7 @@ static  attribute_noinline void InIntegerVec (struct inpar *par, SEXP obj, int l
     {
 	int done, this;
         for (done = 0; done < length; done += this) {
-	    this = min2(CHUNK_SIZE, length - done);
+	    this = min2(BINARY_CHUNK_SIZE, length - done);
 	    stream->InBytes(stream, INTEGER(obj) + done, sizeof(int) * this);
 	}
 	break;
@@ -1573,7 +1587,7 @@ static attribute_noinline void InRealVec (struct inpar *par, SEXP obj, int lengt
     {
 	int done, this;
         for (done = 0; done < length; done += this) {
-	    this = min2(CHUNK_SIZE, length - done);
+	    this = min2(BINARY_CHUNK_SIZE, length - done);
 	    stream->InBytes(stream, REAL(obj) + done, sizeof(double) * this);
 	}
 	break;
@@ -1604,7 +1618,7 @@ static attribute_noinline void InComplexVec (struct inpar *par, SEXP obj, int le
     {
 	int done, this;
         for (done = 0; done < length; done += this) {
-	    this = min2(CHUNK_SIZE, length - done);
+	    this = min2(BINARY_CHUNK_SIZE, length - done);
 	    stream->InBytes(stream, COMPLEX(obj) + done, 
 			    sizeof(Rcomplex) * this);
 	}
@@ -1861,7 +1875,7 @@ static SEXP ReadItem (struct inpar *par)
                 int done, this;
                 PROTECT(s = allocVector(type, len));
                 for (done = 0; done < len; done += this) {
-                    this = min2(CHUNK_SIZE, len - done);
+                    this = min2(BINARY_CHUNK_SIZE, len - done);
                     stream->InBytes(stream, RAW(s) + done, this);
                 }
             }
@@ -2001,24 +2015,19 @@ static void DecodeVersion(int packed, int *v, int *p, int *s)
     *s = packed;
 }
 
-SEXP R_Unserialize(R_inpstream_t stream)
+/* Read the format and version information that precedes the object. */
+
+static void ReadHeader (struct inpar *par)
 {
     int version;
     int writer_version, release_version;
-    SEXP obj;
-
-    struct inpar par;
-    char buf [CBUF_SIZE];
-    par.stream = stream;
-    par.buf = buf;
-    PROTECT(par.ref_table = MakeReadRefTable());
 
-    InFormat(stream);
+    InFormat(par->stream);
 
     /* Read the version numbers */
-    version = InInteger(&par);
-    writer_version = InInteger(&par);
-    release_version = InInteger(&par);
+    version = InInteger(par);
+    writer_version = InInteger(par);
+    release_version = InInteger(par);
     switch (version) {
     case 2: break;
     default:
@@ -2035,6 +2044,19 @@ SEXP R_Unserialize(R_inpstream_t stream)
 	    }
 	}
     }
+}
+
+SEXP R_Unserialize(R_inpstream_t stream)
+{
+    SEXP obj;
+
+    struct inpar par;
+    char buf [CBUF_SIZE];
+    par.stream = stream;
+    par.buf = buf;
+    PROTECT(par.ref_table = MakeReadRefTable());
+
+    ReadHeader (&par);
 
     /* Read the actual object back */
 
@@ -2388,6 +2410,296 @@ SEXP attribute_hidden do_unserializeFromConn(SEXP call, SEXP op, SEXP args, SEXP
 }
 
 
+/*
+ * Streaming Lists
+ */
+
+/* A list can be written one element at a time, and read back one
+   element at a time, so that only one element need be in memory at
+   once.  What is written is exactly what serializing the whole list
+   would produce, so it can also be read with unserialize or readRDS,
+   and any list written by serialize or saveRDS can be read by elements.
+
+   The state is kept in a "liststream" structure referred to by an
+   external pointer.  The reference table, the hook function, and (when
+   writing) the attributes for the list are kept in the protected field
+   of the external pointer.  The connection is looked up again from its
+   number on each call, and checked against its id, so that use after
+   the connection has been closed gives an error rather than a crash. */
+
+struct liststream {
+    int writing;                /* TRUE if writing, FALSE if reading */
+    int conn;                   /* connection number */
+    void *conn_id;              /* id of the connection */
+    int length;                 /* number of elements in the list */
+    int done;                   /* number of elements read or written */
+    int hasattr;                /* does the list have attributes? */
+    int broken;                 /* did an error occur part way through? */
+    struct R_inpstream_st in;
+    struct R_outpstream_st out;
+    struct inpar ipar;
+    struct outpar opar;
+    char buf [CBUF_SIZE];
+};
+
+static void liststream_finalizer (SEXP ptr)
+{
+    free (R_ExternalPtrAddr(ptr));
+    R_ClearExternalPtr(ptr);
+}
+
+/* Make an external pointer for a new liststream, with protected field
+   set to a list of the reference table, hook function, and attributes. */
+
+static SEXP new_liststream (int writing, Rconnection con, int conn,
+                            SEXP ref_table, SEXP fun, SEXP attr)
+{
+    struct liststream *ls;
+    SEXP ptr;
+
+    PROTECT(ref_table);
+    ls = calloc (1, sizeof *ls);
+    if (ls == NULL)
+        error(_("cannot allocate memory for stream"));
+    ls->writing = writing;
+    ls->conn = conn;
+    ls->conn_id = con->id;
+
+    PROTECT(ptr = R_MakeExternalPtr (ls, install("liststream"),
+                                     list3 (ref_table, fun, attr)));
+    R_RegisterCFinalizerEx (ptr, liststream_finalizer, TRUE);
+    UNPROTECT(2);
+
+    return ptr;
+}
+
+/* Get the liststream for an external pointer, checking that it is valid,
+   and set up the pointers in it that may have changed since last used. */
+
+static struct liststream *get_liststream (SEXP ptr, int writing)
+{
+    struct liststream *ls;
+    Rconnection con;
+
+    if (TYPEOF(ptr) != EXTPTRSXP || EXTPTR_TAG(ptr) != install("liststream"))
+        error(_("invalid '%s' argument"), "stream");
+    if ((ls = R_ExternalPtrAddr(ptr)) == NULL)
+        error(_("stream has already been ended"));
+    if (ls->writing != writing)
+        error(_("invalid '%s' argument"), "stream");
+    if (ls->broken)
+        error(_("stream is not usable after an error while reading or writing"));
+
+    con = getConnection_no_err(ls->conn);
+    if (con == NULL || con->id != ls->conn_id)
+        error(_("the connection for the stream has been closed"));
+
+    if (writing) {
+        CheckOutConn(con);
+        ls->out.data = (R_pstream_data_t) con;
+        ls->opar.stream = &ls->out;
+        ls->opar.ref_table = CAR(EXTPTR_PROT(ptr));
+        ls->opar.buf = ls->buf;
+    }
+    else {
+        CheckInConn(con);
+        ls->in.data = (R_pstream_data_t) con;
+        ls->ipar.stream = &ls->in;
+        ls->ipar.ref_table = CAR(EXTPTR_PROT(ptr));
+        ls->ipar.buf = ls->buf;
+    }
+
+    return ls;
+}
+
+/* serializeStream(con, length, attributes, ascii, version, refhook) 
+   Writes the header and the start of a list with the given length, and 
+   returns the stream.  The attributes, a pairlist, are written at the end. */
+
+static SEXP do_serializeStream(SEXP call, SEXP op, SEXP args, SEXP env)
+{
+    SEXP attr, fun, ptr, a;
+    struct liststream *ls;
+    R_pstream_format_t type;
+    Rconnection con;
+    int conn, length, version, asc, objf;
+
+    checkArity(op, args);
+
+    conn = asInteger(CAR(args));
+    con = getConnection(conn);
+    length = asInteger(CADR(args));
+    if (length == NA_INTEGER || length < 0)
+	error(_("invalid '%s' argument"), "length");
+    attr = CADDR(args);
+    if (attr != R_NilValue && TYPEOF(attr) != LISTSXP)
+	error(_("invalid '%s' argument"), "attributes");
+    objf = FALSE;
+    for (a = attr; a != R_NilValue; a = CDR(a))
+        if (TAG(a) == R_ClassSymbol) objf = TRUE;
+
+    asc = asLogical(CADDDR(args));
+    if (asc == NA_LOGICAL) type = R_pstream_binary_format;
+    else if (asc) type = R_pstream_ascii_format;
+    else type = R_pstream_xdr_format;
+
+    if (CAD4R(args) == R_NilValue)
+	version = R_DefaultSerializeVersion;
+    else
+	version = asInteger(CAD4R(args));
+    if (version == NA_INTEGER || version <= 0)
+	error(_("bad version value"));
+
+    fun = CAR(nthcdr(args,5));
+
+    PROTECT(ptr = new_liststream (TRUE, con, conn, MakeHashTable(), fun, attr));
+    ls = R_ExternalPtrAddr(ptr);
+    R_InitConnOutPStream (&ls->out, con, type, version,
+                          fun != R_NilValue ? CallHook : NULL, fun);
+    ls = get_liststream (ptr, TRUE);
+    ls->length = length;
+    ls->hasattr = attr != R_NilValue;
+
+    ls->broken = TRUE;
+    WriteHeader (&ls->opar);
+    OutInteger (&ls->opar, 
+                PackFlags (VECSXP, 0, objf, ls->hasattr, FALSE, FALSE));
+    OutInteger (&ls->opar, length);
+    ls->broken = FALSE;
+
+    UNPROTECT(1);
+    return ptr;
+}
+
+/* serializeNext(stream, object) */
+
+static SEXP do_serializeNext(SEXP call, SEXP op, SEXP args, SEXP env)
+{
+    struct liststream *ls;
+
+    checkArity(op, args);
+    ls = get_liststream (CAR(args), TRUE);
+    if (ls->done == ls->length)
+	error(_("all %d elements of the list have already been written"),
+              ls->length);
+
+    ls->broken = TRUE;
+    WriteItem (&ls->opar, CADR(args));
+    ls->done += 1;
+    ls->broken = FALSE;
+
+    return R_NilValue;
+}
+
+/* serializeEnd(stream) */
+
+static SEXP do_serializeEnd(SEXP call, SEXP op, SEXP args, SEXP env)
+{
+    struct liststream *ls;
+
+    checkArity(op, args);
+    ls = get_liststream (CAR(args), TRUE);
+    if (ls->done < ls->length)
+	error(_("only %d of %d elements of the list have been written"),
+              ls->done, ls->length);
+
+    ls->broken = TRUE;
+    if (ls->hasattr)
+        WriteItem (&ls->opar, CADDR(EXTPTR_PROT(CAR(args))));
+    liststream_finalizer (CAR(args));
+
+    return R_NilValue;
+}
+
+/* unserializeStream(con, refhook)
+   Reads the header and the start of a list, and returns the stream, with
+   the length of the list as its "length" attribute. */
+
+static SEXP do_unserializeStream(SEXP call, SEXP op, SEXP args, SEXP env)
+{
+    SEXP fun, ptr;
+    struct liststream *ls;
+    Rconnection con;
+    int conn, flags, levs, objf, hasattr, hastag, isconstant;
+    SEXPTYPE type;
+
+    checkArity(op, args);
+
+    conn = asInteger(CAR(args));
+    con = getConnection(conn);
+    fun = CADR(args);
+
+    PROTECT(ptr = new_liststream (FALSE, con, conn, MakeReadRefTable(), fun,
+                                  R_NilValue));
+    ls = R_ExternalPtrAddr(ptr);
+    R_InitConnInPStream (&ls->in, con, R_pstream_any_format,
+                         fun != R_NilValue ? CallHook : NULL, fun);
+    ls = get_liststream (ptr, FALSE);
+
+    ls->broken = TRUE;
+    ReadHeader (&ls->ipar);
+    flags = InInteger (&ls->ipar);
+    UnpackFlags (flags, &type, &levs, &objf, &hasattr, &hastag, &isconstant);
+    if (type != VECSXP && type != EXPRSXP)
+	error(_("serialized object is not a list"));
+    ls->length = InInteger (&ls->ipar);
+    ls->hasattr = hasattr;
+    ls->broken = FALSE;
+
+    setAttrib (ptr, install("length"), ScalarInteger(ls->length));
+
+    UNPROTECT(1);
+    return ptr;
+}
+
+/* unserializeNext(stream) */
+
+static SEXP do_unserializeNext(SEXP call, SEXP op, SEXP args, SEXP env)
+{
+    struct liststream *ls;
+    SEXP ans;
+
+    checkArity(op, args);
+    ls = get_liststream (CAR(args), FALSE);
+    if (ls->done == ls->length)
+	error(_("all %d elements of the list have already been read"),
+              ls->length);
+
+    ls->broken = TRUE;
+    ans = ReadItem (&ls->ipar);
+    ls->done += 1;
+    ls->broken = FALSE;
+
+    return ans;
+}
+
+/* unserializeEnd(stream)
+   Skips any elements not yet read, and returns an empty list with the 
+   attributes of the list read. */
+
+static SEXP do_unserializeEnd(SEXP call, SEXP op, SEXP args, SEXP env)
+{
+    struct liststream *ls;
+    SEXP ans;
+
+    checkArity(op, args);
+    ls = get_liststream (CAR(args), FALSE);
+
+    ls->broken = TRUE;
+    while (ls->done < ls->length) {
+        (void) ReadItem (&ls->ipar);
+        ls->done += 1;
+    }
+    PROTECT(ans = allocVector (VECSXP, 0));
+    if (ls->hasattr)
+        SET_ATTRIB (ans, ReadItem (&ls->ipar));
+    liststream_finalizer (CAR(args));
+
+    UNPROTECT(1);
+    return ans;
+}
+
+
 /*
  * Persistent Buffered Binary Connection Streams
  */
@@ -2395,7 +2707,10 @@ SEXP attribute_hidden do_unserializeFromConn(SEXP call, SEXP op, SEXP args, SEXP
 /**** should eventually come from a public header file */
 size_t R_WriteConnection(Rconnection con, void *buf, size_t n);
 
-#define BCONBUFSIZ 4096
+/* Big enough to hold several chunks of XDR-encoded data, so that they
+   are sent together.  Larger blocks of bytes are written directly. */
+
+#define BCONBUFSIZ 65536
 
 typedef struct bconbuf_st {
     Rconnection con;
@@ -2974,6 +3289,12 @@ attribute_hidden FUNTAB R_FunTab_serialize[] =
 
 {"serializeToConn",	do_serializeToConn,	0,	111,	6,	{PP_FUNCALL, PREC_FN,	0}},
 {"unserializeFromConn",	do_unserializeFromConn,	0,	111,	2,	{PP_FUNCALL, PREC_FN,	0}},
+{"serializeStream",	do_serializeStream,	0,	11,	6,	{PP_FUNCALL, PREC_FN,	0}},
+{"serializeNext",	do_serializeNext,	0,	111,	2,	{PP_FUNCALL, PREC_FN,	0}},
+{"serializeEnd",	do_serializeEnd,	0,	111,	1,	{PP_FUNCALL, PREC_FN,	0}},
+{"unserializeStream",	do_unserializeStream,	0,	11,	2,	{PP_FUNCALL, PREC_FN,	0}},
+{"unserializeNext",	do_unserializeNext,	0,	11,	1,	{PP_FUNCALL, PREC_FN,	0}},
+{"unserializeEnd",	do_unserializeEnd,	0,	11,	1,	{PP_FUNCALL, PREC_FN,	0}},
 
 {"lazyLoadDBfetch",do_lazyLoadDBfetch,0,1,	4,	{PP_FUNCALL, PREC_FN,	0}},
 
@@ -2355,6 +2355,52 @@ static SEXP two_matrix_subscripts (SEXP x, SEXP dim, SEXP s1, SEXP s2,
 }
 
 
+/* Sum the elements of x in a range, for a VARIANT_SUM result from x[a:b],
+   without allocating the subset.  The range is given by seq (nonzero),
+   which must specify positive indexes within x.  Returns R_NoObject if
+   this can't be done (including if integer overflow would occur, so that
+   the usual warning is produced by sum).  The result is computed the same
+   way as by sum applied to the subset. */
+
+static SEXP sum_of_range (SEXP x, int64_t seq)
+{
+    int from = seq >= 0 ? seq>>32
+                        : (int64_t)((uint64_t)seq>>32) - ((int64_t)1<<32);
+    int len = (seq & 0xffffffff) >> 1;
+    int i;
+
+    if (from < 1 || len > LENGTH(x) - (from-1))
+        return R_NoObject;
+
+    WAIT_UNTIL_COMPUTED(x);
+
+    switch (TYPEOF(x)) {
+    case LGLSXP:
+    case INTSXP: {
+        int *p = INTEGER(x) + (from-1);
+        int_fast64_t s = 0;
+        for (i = 0; i < len; i++) {
+            if (p[i] == NA_INTEGER) 
+                return ScalarInteger (NA_INTEGER);
+            s += p[i];
+        }
+        if (s > INT_MAX || s <= INT_MIN)
+            return R_NoObject;
+        return ScalarInteger ((int) s);
+    }
+    case REALSXP: {
+        double *p = REAL(x) + (from-1);
+        long double s = 0.0;
+        for (i = 0; i < len; i++)
+            s += p[i];
+        return ScalarReal ((double) s);
+    }
+    default:
+        return R_NoObject;
+    }
+}
+
+
 /* The do_subset function implementing the "[" subset operator is in eval.c. */
 
 /* do_subset_dflt and do_subset_dflt_seq are called from there and elsewhere
@@ -2403,6 +2449,17 @@ SEXP attribute_hidden do_subset_dflt_seq (SEXP call, SEXP op, SEXP x,
 
     R_Visible = TRUE;
 
+    /* For sum(x[a:b]), find the sum directly, rather than creating the
+       subset, when x is a numeric vector without attributes. */
+
+    if (seq != 0 && VARIANT_KIND(variant) == VARIANT_SUM 
+          && sb2 == R_NoObject && subs == R_NilValue 
+          && isVectorAtomic(x) && !HAS_ATTRIB(x)) {
+        SEXP r = sum_of_range (x, seq);
+        if (r != R_NoObject)
+            return r;
+    }
+
     if (seq == 0 && sb1 != R_NoObject && subs==R_NilValue) {
 
         if (sb2 == R_NoObject) {  /* handle simples cases with one subscript */
@@ -4386,7 +4443,9 @@ SEXP attribute_hidden do_subassign_dflt_seq (SEXP call, SEXP x,
              && isVector(x) && !IS_S4_OBJECT(x) && !NAMEDCNT_GT_1(x)
              && y != R_NoObject 
              && (TYPEOF(y) == TYPEOF(x) 
-                  || TYPEOF(x) == REALSXP && TYPEOF(y) == INTSXP)
+                  || TYPEOF(x) == REALSXP && (TYPEOF(y) == INTSXP
+                                               || TYPEOF(y) == LGLSXP)
+                  || TYPEOF(x) == INTSXP && TYPEOF(y) == LGLSXP)
              && LENGTH(y) == 1) {
         R_len_t ix1 = 0;
         if (TYPE_ETC(sb1) == INTSXP) {        /* scalar integer index */
@@ -4430,10 +4489,12 @@ SEXP attribute_hidden do_subassign_dflt_seq (SEXP call, SEXP x,
                     LOGICAL(x)[ix] = *LOGICAL(y);
                     break;
                 case INTSXP: 
-                    INTEGER(x)[ix] = *INTEGER(y);
+                    INTEGER(x)[ix] = *INTEGER(y);  /* y may be LGLSXP */
                     break;
                 case REALSXP: 
-                    REAL(x)[ix] = TYPEOF(y) == REALSXP ? *REAL(y) : *INTEGER(y);
+                    REAL(x)[ix] = TYPEOF(y) == REALSXP ? *REAL(y) 
+                                : *INTEGER(y) == NA_INTEGER ? NA_REAL
+                                : *INTEGER(y);
                     break;
                 case CPLXSXP: 
                     COMPLEX(x)[ix] = *COMPLEX(y);
@@ -33,6 +33,8 @@
 #define R_USE_SIGNALS 1
 #include <Defn.h>
 
+#include <helpers/helpers-app.h>
+
 
 /* STRUCTURE WITH HASH TABLE INFORMATION. */
 
@@ -1618,15 +1620,485 @@ static SEXP do_matchcall(SEXP call, SEXP op, SEXP args, SEXP env)
 #ifdef _AIX  /*some people just have to be different */
 #    include <memory.h>
 #endif
-/* int and double zeros are all bits off */
-#define ZEROINT(X,N,I) do{memset(INTEGER(X),0,(size_t)(N)*sizeof(int));}while(0)
-#define ZERODBL(X,N,I) do{memset(REAL(X),0,(size_t)(N)*sizeof(double));}while(0)
+
+/* GROUPED AGGREGATION.  Computes a statistic for each group of elements in
+   each column of x (which may be a vector, seen as one column), with groups
+   given by integer codes from 1 to ng (or NA, for elements to ignore).  
+   Used by rowsum and by tapply when FUN is sum, mean, min, max, length, 
+   or var, in which case the result for each group is the same as FUN would
+   give (the same operations are done in the same order), or the 
+   computation fails (and tapply falls back to calling FUN) if FUN would 
+   give a warning.  Columns are split amongst helper tasks, if possible. */
+
+#define GSTAT_ROWSUM 0  /* As for rowsum, zero for empty groups */
+#define GSTAT_SUM    1  /* As for sum */
+#define GSTAT_MEAN   2  /* As for mean */
+#define GSTAT_MIN    3  /* As for min */
+#define GSTAT_MAX    4  /* As for max */
+#define GSTAT_COUNT  5  /* As for length */
+#define GSTAT_VAR    6  /* As for var */
+
+struct group_info {
+    int n, ng, p;               /* Number of rows, groups, and columns */
+    int stat, narm;             /* Statistic to compute, remove NAs? */
+    int *g;                     /* Group codes for rows, from 1, or NA */
+    char *work;                 /* Workspaces for tasks */
+    size_t work_size;           /* Size of workspace for one task */
+    Rboolean fail[HELPERS_MAX+1]; /* Set when a task's computation fails */
+};
+
+/* Workspace needed per group, with the long double arrays first, so that 
+   they will be aligned if the workspace is. */
+
+#define GROUP_WORK (2*sizeof(long double) + sizeof(int) + 1)
+
+/* Compute the statistic for the groups in column j of x, storing the 
+   results in column j of ans.  Returns FALSE if the computation fails. */
+
+static Rboolean group_stat_col (struct group_info *info, SEXP x, int j,
+                                SEXP ans, char *work)
+{
+    int n = info->n, ng = info->ng, narm = info->narm, stat = info->stat;
+    const int *g = info->g;
+
+    long double *acc = (long double *) work;
+    long double *mn = acc + ng;
+    int *cnt = (int *) (mn + ng);
+    char *flag = (char *) (cnt + ng);
+
+    R_xlen_t xo = (R_xlen_t) j * n, ao = (R_xlen_t) j * ng;
+    int i, k;
+
+    if (stat == GSTAT_ROWSUM) {
+        if (TYPEOF(x) == REALSXP) {
+            double *rx = REAL(x) + xo, *ra = REAL(ans) + ao;
+            for (k = 0; k < ng; k++) ra[k] = 0;
+            for (i = 0; i < n; i++)
+                if (g[i] != NA_INTEGER && (!narm || !ISNAN(rx[i])))
+                    ra[g[i]-1] += rx[i];
+        }
+        else {
+            int *ix = INTEGER(x) + xo, *ia = INTEGER(ans) + ao;
+            for (k = 0; k < ng; k++) ia[k] = 0;
+            for (i = 0; i < n; i++) {
+                if (g[i] == NA_INTEGER) continue;
+                int *a = &ia[g[i]-1];
+                if (ix[i] == NA_INTEGER) {
+                    if (!narm) *a = NA_INTEGER;
+                } 
+                else if (*a != NA_INTEGER) {
+                    /* check for integer overflows */
+                    double dtmp = (double) *a + ix[i];
+                    *a = dtmp < INT_MIN || dtmp > INT_MAX ? NA_INTEGER 
+                          : *a + ix[i];
+                }
+            }
+        }
+        return TRUE;
+    }
+
+    for (k = 0; k < ng; k++) {
+        acc[k] = 0;
+        cnt[k] = 0;
+        flag[k] = 0;
+    }
+
+    switch (stat) {
+
+    case GSTAT_COUNT:
+        for (i = 0; i < n; i++)
+            if (g[i] != NA_INTEGER) cnt[g[i]-1] += 1;
+        for (k = 0; k < ng; k++)
+            INTEGER(ans)[ao+k] = cnt[k] == 0 ? NA_INTEGER : cnt[k];
+        break;
+
+    case GSTAT_SUM:
+    case GSTAT_MEAN:
+        /* flag is 1 for an integer group that's NA due to an NA element,
+           and has bit 1 set if elements were removed, so an empty group
+           isn't taken as absent.  For mean, cnt is the number of elements
+           not removed.  Whether NA or NaN results from summing both NA and
+           other NaN or infinite values depends on how the compiler uses 
+           the x87 floating point unit, so the computation fails then, 
+           with flag having bits 2 and 3 set to record what was seen. */
+        if (TYPEOF(x) == REALSXP) {
+            double *rx = REAL(x) + xo;
+            for (i = 0; i < n; i++) {
+                if (g[i] == NA_INTEGER) continue;
+                k = g[i]-1;
+                if (!R_FINITE(rx[i])) {
+                    if (narm && ISNAN(rx[i])) {
+                        flag[k] |= 2;
+                        continue;
+                    }
+                    flag[k] |= ISNA(rx[i]) ? 4 : 8;
+                    if ((flag[k] & 12) == 12)
+                        return FALSE;
+                }
+                acc[k] += rx[i];
+                cnt[k] += 1;
+            }
+            if (stat == GSTAT_MEAN) {
+                Rboolean pass2 = FALSE;
+                for (k = 0; k < ng; k++) {
+                    if (cnt[k] == 0) continue;
+                    mn[k] = acc[k] / cnt[k];
+                    acc[k] = 0;
+                    if (R_FINITE((double) mn[k])) pass2 = TRUE;
+                }
+                if (pass2) {
+                    for (i = 0; i < n; i++) {
+                        if (g[i] == NA_INTEGER) continue;
+                        k = g[i]-1;
+                        if (narm && ISNAN(rx[i])) continue;
+                        acc[k] += rx[i] - mn[k];
+                    }
+                }
+                for (k = 0; k < ng; k++) {
+                    double *r = &REAL(ans)[ao+k];
+                    if (cnt[k] == 0) 
+                        *r = flag[k] ? R_NaN : NA_REAL;
+                    else if (R_FINITE((double) mn[k]))
+                        *r = mn[k] + acc[k] / cnt[k];
+                    else
+                        *r = mn[k];
+                }
+            }
+            else {
+                for (k = 0; k < ng; k++)
+                    REAL(ans)[ao+k] = cnt[k] == 0 && !flag[k] ? NA_REAL 
+                                       : (double) acc[k];
+            }
+        }
+        else {
+            int *ix = TYPEOF(x) == INTSXP ? INTEGER(x) + xo : LOGICAL(x) + xo;
+            int_fast64_t *lacc = (int_fast64_t *) acc;
+            for (k = 0; k < ng; k++) lacc[k] = 0;
+            for (i = 0; i < n; i++) {
+                if (g[i] == NA_INTEGER) continue;
+                k = g[i]-1;
+                if (ix[i] == NA_INTEGER) {
+                    flag[k] |= narm ? 2 : 1;
+                    continue;
+                }
+                lacc[k] += ix[i];
+                cnt[k] += 1;
+            }
+            for (k = 0; k < ng; k++) {
+                if (cnt[k] == 0 && flag[k] == 0) {
+                    if (stat == GSTAT_SUM) INTEGER(ans)[ao+k] = NA_INTEGER;
+                    else REAL(ans)[ao+k] = NA_REAL;
+                }
+                else if (stat == GSTAT_SUM) {
+                    if (flag[k] & 1)
+                        INTEGER(ans)[ao+k] = NA_INTEGER;
+                    else if (lacc[k] > INT_MAX || lacc[k] < -INT_MAX)
+                        return FALSE;  /* sum would warn of overflow */
+                    else
+                        INTEGER(ans)[ao+k] = (int) lacc[k];
+                }
+                else {
+                    REAL(ans)[ao+k] = flag[k] & 1 ? NA_REAL 
+                                       : (double) lacc[k] / cnt[k];
+                }
+            }
+        }
+        break;
+
+    case GSTAT_MIN:
+    case GSTAT_MAX:
+        /* flag is 0 before any element, 1 after a value not NA/NaN, 2 after
+           a NaN when NAs not removed (with mn holding it), 3 after NA. */
+        if (TYPEOF(x) == REALSXP) {
+            double *rx = REAL(x) + xo;
+            double *m = REAL(ans) + ao;
+            for (i = 0; i < n; i++) {
+                if (g[i] == NA_INTEGER) continue;
+                k = g[i]-1;
+                cnt[k] += 1;
+                if (flag[k] >= 2) {
+                    if (flag[k] == 2 && ISNA(rx[i])) {
+                        m[k] = rx[i];
+                        flag[k] = 3;
+                    }
+                }
+                else if (ISNAN(rx[i])) {
+                    if (!narm) {
+                        m[k] = rx[i];
+                        flag[k] = ISNA(rx[i]) ? 3 : 2;
+                    }
+                }
+                else if (flag[k] == 0 
+                          || (stat == GSTAT_MIN ? rx[i] < m[k] : rx[i] > m[k])){
+                    m[k] = rx[i];
+                    flag[k] = 1;
+                }
+            }
+            for (k = 0; k < ng; k++) {
+                if (cnt[k] == 0) m[k] = NA_REAL;
+                else if (flag[k] == 0) return FALSE; /* min/max would warn */
+            }
+        }
+        else {
+            int *ix = TYPEOF(x) == INTSXP ? INTEGER(x) + xo : LOGICAL(x) + xo;
+            int *m = INTEGER(ans) + ao;
+            for (i = 0; i < n; i++) {
+                if (g[i] == NA_INTEGER) continue;
+                k = g[i]-1;
+                cnt[k] += 1;
+                if (flag[k] == 3) 
+                    continue;
+                if (ix[i] == NA_INTEGER) {
+                    if (!narm) {
+                        m[k] = NA_INTEGER;
+                        flag[k] = 3;
+                    }
+                }
+                else if (flag[k] == 0
+                          || (stat == GSTAT_MIN ? ix[i] < m[k] : ix[i] > m[k])){
+                    m[k] = ix[i];
+                    flag[k] = 1;
+                }
+            }
+            for (k = 0; k < ng; k++) {
+                if (cnt[k] == 0) m[k] = NA_INTEGER;
+                else if (flag[k] == 0) return FALSE; /* min/max would warn */
+            }
+        }
+        break;
+
+    case GSTAT_VAR: {
+        /* As done by cov for a single column, with use="everything" when
+           NAs aren't removed, and use="na.or.complete" when they are.  The
+           mean is found in two passes, as by MEAN in cov.c, and stored as 
+           a double, then squared deviations from it are summed.  flag has
+           bit 0 set if an NA or NaN was seen, and bit 1 if the group is 
+           present.  GROUP_VAR_OK says whether group k has a variance. */
+
+#       define GROUP_VAR_OK(k) (cnt[k] > 1 && (narm || !(flag[k] & 1)))
+#       define GROUP_VAR_ELT(i) (rx != NULL ? rx[i] \
+                                   : ix[i] == NA_INTEGER ? NA_REAL : ix[i])
+
+        double *rx = TYPEOF(x) == REALSXP ? REAL(x) + xo : NULL;
+        int *ix = TYPEOF(x) == INTSXP ? INTEGER(x) + xo 
+                : TYPEOF(x) == LGLSXP ? LOGICAL(x) + xo : NULL;
+
+        for (i = 0; i < n; i++) {
+            if (g[i] == NA_INTEGER) continue;
+            k = g[i]-1;
+            double v = GROUP_VAR_ELT(i);
+            flag[k] |= 2;
+            if (ISNAN(v))
+                flag[k] |= 1;
+            else {
+                acc[k] += v;
+                cnt[k] += 1;
+            }
+        }
+        for (k = 0; k < ng; k++) {
+            if (GROUP_VAR_OK(k)) mn[k] = acc[k] / cnt[k];
+            acc[k] = 0;
+        }
+        for (i = 0; i < n; i++) {
+            if (g[i] == NA_INTEGER) continue;
+            k = g[i]-1;
+            double v = GROUP_VAR_ELT(i);
+            if (!ISNAN(v) && GROUP_VAR_OK(k) && R_FINITE((double) mn[k]))
+                acc[k] += (v - mn[k]);
+        }
+        for (k = 0; k < ng; k++) {
+            if (GROUP_VAR_OK(k)) {
+                if (R_FINITE((double) mn[k]))
+                    mn[k] = mn[k] + acc[k] / cnt[k];
+                mn[k] = (double) mn[k];
+            }
+            acc[k] = 0;
+        }
+        for (i = 0; i < n; i++) {
+            if (g[i] == NA_INTEGER) continue;
+            k = g[i]-1;
+            double v = GROUP_VAR_ELT(i);
+            if (!ISNAN(v) && GROUP_VAR_OK(k)) {
+                long double d = v - mn[k];
+                acc[k] += d * d;
+            }
+        }
+        for (k = 0; k < ng; k++)
+            REAL(ans)[ao+k] = GROUP_VAR_OK(k) ? acc[k] / (cnt[k]-1) : NA_REAL;
+        break;
+
+#       undef GROUP_VAR_OK
+#       undef GROUP_VAR_ELT
+    }
+    }
+
+    return TRUE;
+}
+
+/* Task procedure for doing the grouped computation for a range of columns,
+   with the output being the result, and the inputs x and a raw vector with
+   a struct group_info.  The op gives w (from 0) in its top bits and s-1 in
+   the next 8 bits (as for task_cov), for a computation split amongst s
+   tasks.  Tasks other than the first wait for earlier tasks before 
+   finishing, so that the result is computed when the last one finishes. */
+
+void task_group_stat (helpers_op_t op, SEXP ans, SEXP x, SEXP sinfo)
+{
+    int w = op >> 40;
+    int s = 1 + ((op >> 32) & 0xff);
+
+    struct group_info *info = (struct group_info *) RAW(sinfo);
+    char *work = info->work + w * info->work_size;
+    int j0 = (int) ((double) info->p * w / s);
+    int j1 = (int) ((double) info->p * (w+1) / s);
+    int j;
+
+    for (j = j0; j < j1; j++) {
+        if (!group_stat_col (info, x, j, ans, work)) {
+            info->fail[w] = TRUE;
+            break;
+        }
+    }
+
+    if (w != 0) {
+        while (helpers_avail0(LENGTH(ans)) < LENGTH(ans)) ;
+    }
+}
+
+/* Do the computation described by *info for x, storing into ans, possibly
+   split amongst helper tasks.  Returns FALSE if the computation failed. */
+
+#define T_group_split THRESHOLD_ADJUST(10000) /* Min elements for each task */
+
+static Rboolean group_stats (struct group_info *info, SEXP x, SEXP ans)
+{
+    SEXP sinfo, swork;
+    Rboolean ok;
+    int w, s;
+
+    s = helpers_not_multithreading_now ? 1 : helpers_num + 1;
+    if (s > info->p) s = info->p;
+    while (s > 1 && (double) s * T_group_split > (double) info->n * info->p)
+        s -= 1;
+    if (s < 1) s = 1;
+
+    /* Workspace size rounded up to a multiple of 16, plus 16 to allow for
+       aligning the start. */
+
+    info->work_size = (info->ng * GROUP_WORK + 15) & ~(size_t)15;
+    PROTECT(swork = allocVector (RAWSXP, s * info->work_size + 16));
+    info->work = (char *) (((uintptr_t) RAW(swork) + 15) & ~(uintptr_t)15);
+
+    for (w = 0; w <= HELPERS_MAX; w++) 
+        info->fail[w] = FALSE;
+
+    PROTECT(sinfo = allocVector (RAWSXP, sizeof *info));
+    memcpy (RAW(sinfo), info, sizeof *info);
+
+    if (s <= 1)
+        task_group_stat (0, ans, x, sinfo);
+    else {
+        for (w = 0; w < s; w++)
+            helpers_do_task (w == 0   ? HELPERS_PIPE_OUT :
+                             w < s-1  ? HELPERS_PIPE_IN0_OUT 
+                                      : HELPERS_PIPE_IN0,
+                             task_group_stat,
+                             ((helpers_op_t)w<<40) | ((helpers_op_t)(s-1)<<32),
+                             ans, x, sinfo);
+        WAIT_UNTIL_COMPUTED(ans);
+    }
+
+    info = (struct group_info *) RAW(sinfo);
+    ok = TRUE;
+    for (w = 0; w < s; w++)
+        if (info->fail[w]) ok = FALSE;
+
+    UNPROTECT(2);
+    return ok;
+}
+
+/* .Internal(groupstat(x, group, ngroups, stat, na.rm)), as used by tapply.
+   Returns NULL if the computation fails, in which case the caller should
+   do it another way.  The result has dimensions ngroups by ncols if x has
+   dimensions, and is otherwise a vector. */
+
+static SEXP do_groupstat (SEXP call, SEXP op, SEXP args, SEXP env)
+{
+    static const char *stats[] = 
+      { "rowsum", "sum", "mean", "min", "max", "length", "var", NULL };
+
+    struct group_info info;
+    SEXP x, g, ans;
+    int i, n, ng, p, stat, narm, type;
+    const char *s;
+
+    checkArity (op, args);
+
+    x = CAR(args); args = CDR(args);
+    g = CAR(args); args = CDR(args);
+    ng = asInteger(CAR(args)); args = CDR(args);
+    if (!isString(CAR(args)) || LENGTH(CAR(args)) != 1)
+        error(_("invalid '%s' argument"), "stat");
+    s = CHAR(STRING_ELT(CAR(args),0)); args = CDR(args);
+    narm = asLogical(CAR(args));
+
+    for (stat = 0; stats[stat] != NULL && strcmp(s,stats[stat]) != 0; stat++) ;
+    if (stats[stat] == NULL)
+        error(_("invalid '%s' argument"), "stat");
+    if (narm == NA_LOGICAL) 
+        error(_("invalid '%s' argument"), "na.rm");
+    if (ng == NA_INTEGER || ng < 0)
+        error(_("invalid '%s' argument"), "ngroups");
+
+    if (TYPEOF(g) != INTSXP)
+        error(_("invalid '%s' argument"), "group");
+    n = LENGTH(g);
+    for (i = 0; i < n; i++)
+        if (INTEGER(g)[i] != NA_INTEGER 
+             && (INTEGER(g)[i] < 1 || INTEGER(g)[i] > ng))
+            error(_("invalid '%s' argument"), "group");
+
+    type = TYPEOF(x);
+    if (type != REALSXP && type != INTSXP 
+          && (type != LGLSXP || stat == GSTAT_ROWSUM))
+        error(_("invalid '%s' argument"), "x");
+    if (n == 0 ? LENGTH(x) != 0 : LENGTH(x) % n != 0)
+        error(_("incorrect length for 'group'"));
+    p = n == 0 ? 0 : LENGTH(x) / n;
+
+    switch (stat) {
+    case GSTAT_SUM: case GSTAT_MIN: case GSTAT_MAX: 
+        if (type == LGLSXP) type = INTSXP;
+        break;
+    case GSTAT_MEAN: case GSTAT_VAR:
+        type = REALSXP;
+        break;
+    case GSTAT_COUNT:
+        type = INTSXP;
+        break;
+    }
+
+    if (isNull(getAttrib(x, R_DimSymbol)))
+        PROTECT(ans = allocVector (type, (R_xlen_t) ng * p));
+    else
+        PROTECT(ans = allocMatrix (type, ng, p));
+
+    info.n = n; info.ng = ng; info.p = p;
+    info.stat = stat; info.narm = narm;
+    info.g = INTEGER(g);
+
+    if (!group_stats (&info, x, ans))
+        ans = R_NilValue;
+
+    UNPROTECT(1);
+    return ans;
+}
 
 SEXP attribute_hidden
 Rrowsum_matrix(SEXP x, SEXP ncol, SEXP g, SEXP uniqueg, SEXP snarm)
 {
     SEXP matches,ans;
-    int i, j, n, p, ng = 0, offset, offsetg, narm;
+    int n, p, ng = 0, narm;
     HashData data;
     data.nomatch = 0;
 
@@ -1642,48 +2114,15 @@ Rrowsum_matrix(SEXP x, SEXP ncol, SEXP g, SEXP uniqueg, SEXP snarm)
     DoHashing(uniqueg, &data);
     PROTECT(matches = HashLookup (g, &data));
 
-    PROTECT(ans = allocMatrix(TYPEOF(x), ng, p));
+    if (TYPEOF(x) != REALSXP && TYPEOF(x) != INTSXP)
+	error(_("non-numeric matrix in rowsum(): this cannot happen"));
 
-    offset = 0; offsetg = 0;
+    PROTECT(ans = allocMatrix(TYPEOF(x), ng, p));
 
-    switch(TYPEOF(x)){
-    case REALSXP:
-	ZERODBL(ans, ng*p, i);
-	for(i = 0; i < p; i++) {
-	    for(j = 0; j < n; j++)
-		if(!narm || !ISNAN(REAL(x)[j+offset]))
-		    REAL(ans)[INTEGER(matches)[j]-1+offsetg]
-			+= REAL(x)[j+offset];
-	    offset += n;
-	    offsetg += ng;
-	}
-	break;
-    case INTSXP:
-	ZEROINT(ans, ng*p, i);
-	for(i = 0; i < p; i++) {
-	    for(j = 0; j < n; j++) {
-		if (INTEGER(x)[j+offset] == NA_INTEGER) {
-		    if(!narm)
-			INTEGER(ans)[INTEGER(matches)[j]-1+offsetg]
-			    = NA_INTEGER;
-		} else if (INTEGER(ans)[INTEGER(matches)[j]-1+offsetg]
-			   != NA_INTEGER) {
-		    /* check for integer overflows */
-		    int itmp = INTEGER(ans)[INTEGER(matches)[j]-1+offsetg];
-		    double dtmp = itmp;
-		    dtmp += INTEGER(x)[j+offset];
-		    if (dtmp < INT_MIN || dtmp > INT_MAX) itmp = NA_INTEGER;
-		    else itmp += INTEGER(x)[j+offset];
-		    INTEGER(ans)[INTEGER(matches)[j]-1+offsetg] = itmp;
-		}
-	    }
-	    offset += n;
-	    offsetg += ng;
-	}
-	break;
-    default:
-	error(_("non-numeric matrix in rowsum(): this cannot happen"));
-    }
+    struct group_info info = { .n = n, .ng = ng, .p = p, 
+                               .stat = GSTAT_ROWSUM, .narm = narm,
+                               .g = INTEGER(matches) };
+    group_stats (&info, x, ans);
 
     UNPROTECT(2); /* ans, matches*/
     VMAXSET(vmax);
@@ -1694,7 +2133,7 @@ SEXP attribute_hidden
 Rrowsum_df(SEXP x, SEXP ncol, SEXP g, SEXP uniqueg, SEXP snarm)
 {
     SEXP matches,ans,col,xcol;
-    int i, j, n, p, ng = 0, narm;
+    int i, n, p, ng = 0, narm;
     HashData data;
     data.nomatch = 0;
 
@@ -1712,36 +2151,19 @@ Rrowsum_df(SEXP x, SEXP ncol, SEXP g, SEXP uniqueg, SEXP snarm)
 
     PROTECT(ans = allocVector(VECSXP, p));
 
+    struct group_info info = { .n = n, .ng = ng, .p = 1, 
+                               .stat = GSTAT_ROWSUM, .narm = narm,
+                               .g = INTEGER(matches) };
+
     for(i = 0; i < p; i++) {
 	xcol = VECTOR_ELT(x,i);
 	if (!isNumeric(xcol))
 	    error(_("non-numeric data frame in rowsum"));
 	switch(TYPEOF(xcol)){
 	case REALSXP:
-	    PROTECT(col = allocVector(REALSXP,ng));
-	    ZERODBL(col, ng, i);
-	    for(j = 0; j < n; j++)
-		if(!narm || !ISNAN(REAL(xcol)[j]))
-		    REAL(col)[INTEGER(matches)[j]-1] += REAL(xcol)[j];
-	    SET_VECTOR_ELT(ans,i,col);
-	    UNPROTECT(1);
-	    break;
 	case INTSXP:
-	    PROTECT(col = allocVector(INTSXP, ng));
-	    ZEROINT(col, ng, i);
-	    for(j = 0; j < n; j++) {
-		if (INTEGER(xcol)[j] == NA_INTEGER) {
-		    if(!narm)
-			INTEGER(col)[INTEGER(matches)[j]-1] = NA_INTEGER;
-		} else if (INTEGER(col)[INTEGER(matches)[j]-1] != NA_INTEGER) {
-		    int itmp = INTEGER(col)[INTEGER(matches)[j]-1];
-		    double dtmp = itmp;
-		    dtmp += INTEGER(xcol)[j];
-		    if (dtmp < INT_MIN || dtmp > INT_MAX) itmp = NA_INTEGER;
-		    else itmp += INTEGER(xcol)[j];
-		    INTEGER(col)[INTEGER(matches)[j]-1] = itmp;
-		}
-	    }
+	    PROTECT(col = allocVector(TYPEOF(xcol), ng));
+	    group_stats (&info, xcol, col);
 	    SET_VECTOR_ELT(ans, i, col);
 	    UNPROTECT(1);
 	    break;
@@ -1906,6 +2328,7 @@ attribute_hidden FUNTAB R_FunTab_unique[] =
 {"charmatch",	do_charmatch,	0,   1000011,	3,	{PP_FUNCALL, PREC_FN,	0}},
 {"match.call",	do_matchcall,	0,	11,	3,	{PP_FUNCALL, PREC_FN,	0}},
 {"make.unique",	do_makeunique,	0,   1000011,	2,	{PP_FUNCALL, PREC_FN,	0}},
+{"groupstat",	do_groupstat,	0,   1000011,	5,	{PP_FUNCALL, PREC_FN,	0}},
 
 {NULL,		NULL,		0,	0,	0,	{PP_INVALID, PREC_FN,	0}}
 };
@@ -491,6 +491,37 @@ int R_SockConnect(int port, char *host, int timeout)
     return(-1); */
 }
 
+#ifndef Win32
+int R_SockOpenUnix(const char *path)
+{
+    check_init();
+    return Sock_open_unix(path, NULL);
+}
+
+/* The socket is made non-blocking, as for R_SockConnect */
+int R_SockConnectUnix(const char *path)
+{
+    int s, status;
+
+    check_init();
+    s = Sock_connect_unix(path, NULL);
+    if (s < 0) return -1;
+#ifdef HAVE_FCNTL
+    if ((status = fcntl(s, F_GETFL, 0)) != -1) {
+#ifdef O_NONBLOCK
+	status |= O_NONBLOCK;
+#else /* O_NONBLOCK */
+#ifdef F_NDELAY
+	status |= F_NDELAY;
+#endif /* F_NDELAY */
+#endif /* !O_NONBLOCK */
+	status = fcntl(s, F_SETFL, status);
+    }
+#endif
+    return s;
+}
+#endif
+
 int R_SockClose(int sockp)
 {
     return closesocket(sockp);
@@ -536,7 +567,7 @@ int R_SockWrite(int sockp, const void *buf, int len, int timeout)
 	res = (int) send(sockp, buf, len, 0);
 	if (res < 0 && socket_errno() != EWOULDBLOCK)
 	    return -socket_errno();
-	else {
+	else if (res > 0) {
 	    { const char *cbuf = buf; cbuf += res; buf = cbuf; }
 	    len -= res;
 	    out += res;
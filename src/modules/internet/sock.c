@@ -48,6 +48,7 @@
 #    include <netdb.h>
 #    include <sys/socket.h>
 #    include <netinet/in.h>
+#    include <sys/un.h>
 #  endif
 #endif
 
@@ -237,6 +238,72 @@ int Sock_connect(Sock_port_t port, char *sname, Sock_error_t perr)
 #endif
 }
 
+#ifndef Win32
+static int Sock_unix_addr(const char *path, struct sockaddr_un *addr)
+{
+    if (strlen(path) >= sizeof(addr->sun_path))
+	return -1;
+    memset(addr, 0, sizeof(*addr));
+    addr->sun_family = AF_UNIX;
+    strcpy(addr->sun_path, path);
+    return 0;
+}
+
+/* open a Unix-domain server socket, replacing any file at path */
+int Sock_open_unix(const char *path, Sock_error_t perr)
+{
+#ifdef HAVE_SOCKETS
+    struct sockaddr_un server;
+    int sock;
+
+    if (Sock_unix_addr(path, &server) < 0)
+	return Sock_error(perr, ENAMETOOLONG, 0);
+    if ((sock = socket(AF_UNIX, SOCK_STREAM, 0)) < 0)
+	return Sock_error(perr, errno, 0);
+
+    unlink(path);
+    if ((bind(sock, (struct sockaddr *)&server, sizeof(server)) < 0) ||
+	(listen(sock, MAXBACKLOG) < 0)) {
+	Sock_error(perr, errno, 0);
+	close(sock);
+	return -1;
+    }
+    return sock;
+#else
+    error(socket_msg);
+    return(-1);
+#endif
+}
+
+/* connect to a Unix-domain socket */
+int Sock_connect_unix(const char *path, Sock_error_t perr)
+{
+#ifdef HAVE_SOCKETS
+    struct sockaddr_un server;
+    int sock;
+    int retval;
+
+    if (Sock_unix_addr(path, &server) < 0)
+	return Sock_error(perr, ENAMETOOLONG, 0);
+    if ((sock = socket(AF_UNIX, SOCK_STREAM, 0)) < 0)
+	return Sock_error(perr, errno, 0);
+
+    do
+	retval = connect(sock, (struct sockaddr *) &server, sizeof(server));
+    while (retval == -1 && errno == EINTR);
+    if (retval == -1) {
+	Sock_error(perr, errno, 0);
+	close(sock);
+	return -1;
+    }
+    return sock;
+#else
+    error(socket_msg);
+    return(-1);
+#endif
+}
+#endif
+
 /* close a socket */
 int Sock_close(int fd, Sock_error_t perr)
 {
@@ -36,6 +36,10 @@ int Sock_init(void);
 int Sock_open(Sock_port_t port, Sock_error_t perr);
 int Sock_listen(int fd, char *cname, int buflen, Sock_error_t perr);
 int Sock_connect(Sock_port_t port, char *sname, Sock_error_t perr);
+#ifndef Win32
+int Sock_open_unix(const char *path, Sock_error_t perr);
+int Sock_connect_unix(const char *path, Sock_error_t perr);
+#endif
 int Sock_close(int fd, Sock_error_t perr);
 ssize_t Sock_read(int fd, void *buf, size_t nbytes, Sock_error_t perr);
 ssize_t Sock_write(int fd, const void *buf, size_t nbytes, Sock_error_t perr);
@@ -57,6 +61,10 @@ int R_SockConnect(int port, char *host, int timeout);
 int R_SockClose(int sockp);
 int R_SockRead(int sockp, void *buf, int maxlen, int blocking, int timeout);
 int R_SockWrite(int sockp, const void *buf, int len, int timeout);
+#ifndef Win32
+int R_SockOpenUnix(const char *path);
+int R_SockConnectUnix(const char *path);
+#endif
 
 /* from Rhttpd.c */
 int in_R_HTTPDCreate(const char *ip, int port);
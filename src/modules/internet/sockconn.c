@@ -34,6 +34,9 @@
 #include <R_ext/R-ftp-http.h>
 #include "sock.h"
 #include <errno.h>
+#ifdef HAVE_UNISTD_H
+#include <unistd.h>
+#endif
 
 static void listencleanup(void *data)
 {
@@ -41,6 +44,58 @@ static void listencleanup(void *data)
     R_SockClose(*psock);
 }
 
+/* A host of the form "unix:path" specifies a Unix-domain socket with
+   the given path, for a connection to a process on the same machine.
+   A server creates the socket, and removes it once a client has
+   connected.  Returns the socket, or -1 after a warning. */
+
+static int sock_open_unix(Rconnection con, int timeout)
+{
+#ifdef Win32
+    warning("Unix-domain sockets are not supported on this platform");
+    return -1;
+#else
+    Rsockconn this = (Rsockconn)con->private;
+    const char *path = con->description + 5;
+    int sock, sock1;
+
+    if(this->server) {
+	sock1 = R_SockOpenUnix(path);
+	if(sock1 < 0) {
+	    warning("socket %s cannot be opened", path);
+	    return -1;
+	}
+	{
+	    RCNTXT cntxt;
+
+	    /* set up a context which will close socket on jump. */
+	    begincontext(&cntxt, CTXT_CCODE, R_NilValue, R_BaseEnv,
+			 R_BaseEnv, R_NilValue, R_NilValue);
+	    cntxt.cend = &listencleanup;
+	    cntxt.cenddata = &sock1;
+	    sock = R_SockListen(sock1, NULL, 0, timeout);
+	    endcontext(&cntxt);
+	}
+	R_SockClose(sock1);
+	unlink(path);
+	if(sock < 0) {
+	    warning("problem in listening on this socket");
+	    return -1;
+	}
+    } else {
+	sock = R_SockConnectUnix(path);
+	if(sock < 0) {
+	    warning("socket %s cannot be opened", path);
+	    return -1;
+	}
+    }
+    memmove(con->description + 2, con->description,
+	    strlen(con->description) + 1);
+    memcpy(con->description, this->server ? "<-" : "->", 2);
+    return sock;
+#endif
+}
+
 static Rboolean sock_open(Rconnection con)
 {
     Rsockconn this = (Rsockconn)con->private;
@@ -51,7 +106,10 @@ static Rboolean sock_open(Rconnection con)
     if(timeout == NA_INTEGER || timeout <= 0) timeout = 60;
     this->pend = this->pstart = this->inbuf;
 
-    if(this->server) {
+    if(strncmp(con->description, "unix:", 5) == 0) {
+	sock = sock_open_unix(con, timeout);
+	if(sock < 0) return FALSE;
+    } else if(this->server) {
 	sock1 = R_SockOpen(this->port);
 	if(sock1 < 0) {
 	    warning("port %d cannot be opened", this->port);
@@ -112,11 +170,16 @@ static int sock_read_helper(Rconnection con, void *ptr, size_t size)
 
     con->incomplete = FALSE;
     do {
-	/* read data into the buffer if it's empty and size > 0 */
+	/* read data into the buffer if it's empty and size > 0, or
+	   directly into ptr if at least a buffer's worth is wanted, as
+	   when a large vector is being unserialized */
 	if (size > 0 && this->pstart == this->pend) {
+	    int direct = size >= sizeof this->inbuf;
 	    this->pstart = this->pend = this->inbuf;
 	    do
-		res = R_SockRead(this->fd, this->inbuf, 4096, 
+		res = R_SockRead(this->fd, direct ? ptr : this->inbuf,
+				 direct ? (size > INT_MAX ? INT_MAX : size)
+				        : sizeof this->inbuf,
 				 con->blocking, this->timeout);
 	    while (-res == EINTR);
 	    if (! con->blocking && -res == EAGAIN) {
@@ -126,6 +189,12 @@ static int sock_read_helper(Rconnection con, void *ptr, size_t size)
 	    else if (res == 0) /* should mean EOF */
 		return nread;
 	    else if (res < 0) return res;
+	    else if (direct) {
+		ptr = ((char *) ptr) + res;
+		size -= res;
+		nread += res;
+		continue;
+	    }
 	    else this->pend = this->inbuf + res;
 	}
 